@@ -0,0 +1,133 @@
+// 文件描述符I/O与iostream的吞吐量对比: Zip::compressFd/decompressFd vs Zip::compressStream/decompressStream
+// 用法: fd_bench [数据大小MB=64] [压缩级别=6] [重复次数=5]
+#include "zip.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// 生成中等可压缩的测试数据 (随机单词组成的文本)
+static std::vector<uint8_t> makeData(size_t size) {
+    static const char* words[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta",
+                                  "iota", "kappa", "lambda", "mu", "nu", "xi", "omicron", "pi"};
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> data;
+    data.reserve(size + 16);
+    while (data.size() < size) {
+        const char* word = words[rng() % 16];
+        data.insert(data.end(), word, word + std::char_traits<char>::length(word));
+        data.push_back(rng() % 8 == 0 ? '\n' : ' ');
+    }
+    data.resize(size);
+    return data;
+}
+
+static std::string tempPath(const char* name) {
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp") + "/zip_fd_bench_" + std::to_string(::getpid()) + "_" + name;
+}
+
+static void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!out) throw std::runtime_error("Failed to write file: " + path);
+}
+
+// 打开文件, 离开作用域时关闭 (计时的操作抛出时也不泄漏描述符)
+class Fd {
+public:
+    Fd(const std::string& path, int flags) : fd_(::open(path.c_str(), flags, 0644)) {
+        if (fd_ < 0) throw std::runtime_error("Failed to open file: " + path);
+    }
+    ~Fd() { ::close(fd_); }
+    Fd(const Fd&) = delete;
+    Fd& operator=(const Fd&) = delete;
+    
+    int get() const { return fd_; }
+    
+private:
+    int fd_;
+};
+
+// 重复执行run并返回最短耗时 (秒); 每次执行前由run自行打开文件
+static double best(int iterations, const std::function<void()>& run) {
+    double result = 0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || seconds < result) result = seconds;
+    }
+    return result;
+}
+
+static void report(const char* name, size_t bytes, double seconds) {
+    std::printf("%-22s %8.3f s %10.1f MB/s\n", name, seconds, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char** argv) {
+    size_t sizeMb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    int level = argc > 2 ? std::atoi(argv[2]) : 6;
+    int iterations = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+
+    std::string rawPath = tempPath("raw");
+    std::string zPath = tempPath("z");
+    std::string outPath = tempPath("out");
+
+    try {
+        std::vector<uint8_t> data = makeData(sizeMb * 1024 * 1024);
+        writeFile(rawPath, data);
+        {
+            std::ifstream in(rawPath, std::ios::binary);
+            std::ofstream out(zPath, std::ios::binary | std::ios::trunc);
+            Zip::compressStream(in, out, level);
+        }
+        std::printf("data %zu MB, level %d, best of %d\n", sizeMb, level, iterations);
+
+        // 压缩: 按原始数据量计算吞吐量
+        report("compressStream", data.size(), best(iterations, [&] {
+            std::ifstream in(rawPath, std::ios::binary);
+            std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+            Zip::compressStream(in, out, level);
+        }));
+        report("compressFd", data.size(), best(iterations, [&] {
+            Fd in(rawPath, O_RDONLY);
+            Fd out(outPath, O_WRONLY | O_CREAT | O_TRUNC);
+            Zip::compressFd(in.get(), out.get(), level);
+        }));
+
+        // 解压: 同样按原始数据量计算
+        report("decompressStream", data.size(), best(iterations, [&] {
+            std::ifstream in(zPath, std::ios::binary);
+            std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+            Zip::decompressStream(in, out);
+        }));
+        report("decompressFd", data.size(), best(iterations, [&] {
+            Fd in(zPath, O_RDONLY);
+            Fd out(outPath, O_WRONLY | O_CREAT | O_TRUNC);
+            Zip::decompressFd(in.get(), out.get());
+        }));
+    } catch (const std::exception& e) {
+        std::cerr << "fd_bench: " << e.what() << "\n";
+        std::remove(rawPath.c_str());
+        std::remove(zPath.c_str());
+        std::remove(outPath.c_str());
+        return 1;
+    }
+
+    std::remove(rawPath.c_str());
+    std::remove(zPath.c_str());
+    std::remove(outPath.c_str());
+    return 0;
+}
@@ -5,208 +5,3953 @@
 #include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <array>
+#include <atomic>
+#include <tuple>
+#include <mutex>
+#include <cstdlib>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <deque>
+#include <condition_variable>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
 
-// 压缩实现
-std::vector<uint8_t> Zip::compress(const std::vector<uint8_t>& data, int level) {
+#if defined(__unix__) || defined(__APPLE__)
+#define ZIP_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ZIP_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+// avail_in/avail_out 为32位, 超大缓冲区需分段喂入
+static constexpr size_t MAX_CHUNK = std::numeric_limits<uInt>::max();
+
+// 验证压缩级别
+static void checkLevel(int level) {
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument("Compression level must be between 0 and 9");
+    }
+}
+
+// 在已初始化的deflate流上压缩整块数据到固定输出区, 返回写入字节数
+static size_t deflateInto(z_stream& stream, const uint8_t* data, size_t size,
+                          uint8_t* output, size_t capacity) {
+    size_t remainingIn = size;
+    size_t remainingOut = capacity;
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = 0;
+    stream.next_out = output;
+    stream.avail_out = 0;
+    
+    int ret;
+    do {
+        if (stream.avail_in == 0 && remainingIn > 0) {
+            stream.avail_in = static_cast<uInt>(std::min(remainingIn, MAX_CHUNK));
+            remainingIn -= stream.avail_in;
+        }
+        if (stream.avail_out == 0 && remainingOut > 0) {
+            stream.avail_out = static_cast<uInt>(std::min(remainingOut, MAX_CHUNK));
+            remainingOut -= stream.avail_out;
+        }
+        
+        ret = deflate(&stream, remainingIn == 0 ? Z_FINISH : Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR) {
+            throw std::runtime_error("Compression failed: " + std::string(zError(ret)));
+        }
+        if (ret != Z_STREAM_END && stream.avail_out == 0 && remainingOut == 0) {
+            throw std::runtime_error("Compression failed: output buffer too small");
+        }
+    } while (ret != Z_STREAM_END);
+    
+    return capacity - remainingOut - stream.avail_out;
+}
+
+// 单个z_stream增量解压: 输出缓冲区按需扩容(不超过maxSize), 已解出的字节不会被重复解压
+static void inflateGrowing(z_stream& stream, const uint8_t* data, size_t size,
+                           size_t initialCapacity, size_t maxSize, std::vector<uint8_t>& result) {
+    result.resize(std::min(initialCapacity, maxSize));
+    size_t produced = 0;
+    size_t remaining = size;
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = 0;
+    
+    int ret;
+    do {
+        if (stream.avail_in == 0 && remaining > 0) {
+            stream.avail_in = static_cast<uInt>(std::min(remaining, MAX_CHUNK));
+            remaining -= stream.avail_in;
+        }
+        
+        // 输出已满时翻倍扩容, 只追加新空间
+        if (produced == result.size() && result.size() < maxSize) {
+            size_t grown = std::max<size_t>(result.size() * 2, 64);
+            result.resize(std::min(grown, maxSize));
+        }
+        
+        // 已达上限时只用1字节探测缓冲区确认流是否结束, 不再分配内存
+        uint8_t probe;
+        bool probing = (produced == result.size());
+        size_t space = probing ? 1 : std::min(result.size() - produced, MAX_CHUNK);
+        stream.next_out = probing ? &probe : result.data() + produced;
+        stream.avail_out = static_cast<uInt>(space);
+        
+        // 输入已全部交给zlib时使用Z_FINISH, 输出空间足够时一次调用即可完成
+        ret = inflate(&stream, remaining == 0 ? Z_FINISH : Z_NO_FLUSH);
+        
+        if (probing && stream.avail_out == 0) {
+            throw std::runtime_error("Decompression failed: output exceeds limit of " +
+                                     std::to_string(maxSize) + " bytes");
+        }
+        produced += space - stream.avail_out;
+        
+        if (ret == Z_BUF_ERROR && stream.avail_out != 0 && stream.avail_in == 0 && remaining == 0) {
+            throw std::runtime_error("Decompression failed: unexpected end of input");
+        }
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            throw std::runtime_error("Decompression failed: " + std::string(zError(ret)));
+        }
+        
+        // 串接的成员: 一个成员结束而后面还有数据时, 重置后接着解压下一个成员
+        if (ret == Z_STREAM_END && (stream.avail_in > 0 || remaining > 0)) {
+            inflateReset(&stream);
+            ret = Z_OK;
+        }
+    } while (ret != Z_STREAM_END);
+    
+    result.resize(produced);
+}
+
+// 在已初始化的inflate流上解压整块数据到固定输出区, 返回写入字节数
+static size_t inflateInto(z_stream& stream, const uint8_t* data, size_t size,
+                          uint8_t* output, size_t capacity) {
+    size_t remainingIn = size;
+    size_t remainingOut = capacity;
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = 0;
+    stream.next_out = output;
+    stream.avail_out = 0;
+    
+    int ret;
+    do {
+        if (stream.avail_in == 0 && remainingIn > 0) {
+            stream.avail_in = static_cast<uInt>(std::min(remainingIn, MAX_CHUNK));
+            remainingIn -= stream.avail_in;
+        }
+        if (stream.avail_out == 0 && remainingOut > 0) {
+            stream.avail_out = static_cast<uInt>(std::min(remainingOut, MAX_CHUNK));
+            remainingOut -= stream.avail_out;
+        }
+        
+        // 输出区已用尽时用1字节探测, 确认流是否恰好结束
+        uint8_t probe;
+        bool probing = (stream.avail_out == 0);
+        uint8_t* resume = stream.next_out;
+        if (probing) {
+            stream.next_out = &probe;
+            stream.avail_out = 1;
+        }
+        
+        ret = inflate(&stream, remainingIn == 0 ? Z_FINISH : Z_NO_FLUSH);
+        
+        if (probing && stream.avail_out == 0) {
+            throw std::runtime_error("Decompression failed: output buffer too small");
+        }
+        if (ret == Z_BUF_ERROR && stream.avail_out != 0 && stream.avail_in == 0 && remainingIn == 0) {
+            throw std::runtime_error("Decompression failed: unexpected end of input");
+        }
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            throw std::runtime_error("Decompression failed: " + std::string(zError(ret)));
+        }
+        
+        if (probing) {
+            stream.next_out = resume;
+            stream.avail_out = 0;
+        }
+        
+        // 串接的成员
+        if (ret == Z_STREAM_END && (stream.avail_in > 0 || remainingIn > 0)) {
+            inflateReset(&stream);
+            ret = Z_OK;
+        }
+    } while (ret != Z_STREAM_END);
+    
+    return capacity - remainingOut - stream.avail_out;
+}
+
+// 通用流式压缩循环: source(data)给出下一段输入并返回其长度 (不超过MAX_CHUNK, 0表示输入结束),
+// 输出在outBuf中攒满后才交给sink(data, size), 最后一次交出剩余部分
+template <typename Source, typename Sink>
+static void deflateChunksTo(z_stream& stream, Source&& source, Sink&& sink, uint8_t* outBuf, size_t outSize) {
+    stream.next_out = outBuf;
+    stream.avail_out = static_cast<uInt>(outSize);
+    
+    int flush;
+    do {
+        const uint8_t* data = nullptr;
+        size_t size = source(data);
+        flush = size == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = static_cast<uInt>(size);
+        
+        for (;;) {
+            int err = deflate(&stream, flush);
+            if (err == Z_STREAM_ERROR) {
+                throw std::runtime_error("Compression error: " + std::string(zError(err)));
+            }
+            if (stream.avail_out > 0) break;
+            
+            sink(outBuf, outSize);
+            stream.next_out = outBuf;
+            stream.avail_out = static_cast<uInt>(outSize);
+        }
+    } while (flush != Z_FINISH);
+    
+    size_t have = outSize - stream.avail_out;
+    if (have > 0) sink(outBuf, have);
+}
+
+// 通用流式解压循环, source与sink约定同deflateChunksTo.
+// 串接的多个成员 (如追加写入的日志段) 依次解压, 成员之后的数据必须是下一个成员
+template <typename Source, typename Sink>
+static void inflateChunksTo(z_stream& stream, Source&& source, Sink&& sink, uint8_t* outBuf, size_t outSize) {
+    stream.next_out = outBuf;
+    stream.avail_out = static_cast<uInt>(outSize);
+    stream.avail_in = 0;
+    
+    int ret = Z_OK;
+    for (;;) {
+        if (stream.avail_in == 0) {
+            const uint8_t* data = nullptr;
+            size_t size = source(data);
+            if (size == 0) break;
+            stream.next_in = const_cast<Bytef*>(data);
+            stream.avail_in = static_cast<uInt>(size);
+        }
+        
+        // 上一个成员已结束而后面还有数据: 重置后解压下一个成员
+        if (ret == Z_STREAM_END) inflateReset(&stream);
+        
+        for (;;) {
+            ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || 
+                ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+            }
+            if (ret == Z_STREAM_END || stream.avail_out > 0) break;
+            
+            sink(outBuf, outSize);
+            stream.next_out = outBuf;
+            stream.avail_out = static_cast<uInt>(outSize);
+        }
+    }
+    
+    size_t have = outSize - stream.avail_out;
+    if (have > 0) sink(outBuf, have);
+    
+    if (ret != Z_STREAM_END) {
+        throw std::runtime_error("Decompression incomplete");
+    }
+}
+
+// === 缓冲区回收 ===
+
+// 线程本地回收池保留的缓冲区个数与可回收的最大容量
+static constexpr size_t BUFFER_POOL_SIZE = 4;
+static constexpr size_t BUFFER_POOL_MAX = 4 * 1024 * 1024;
+
+static thread_local std::vector<std::vector<uint8_t>> bufferPool;
+
+// 从线程本地池租用的缓冲区, 析构时归还; 大量短流由此复用内存, 不必每次分配并清零
+class PooledBuffer {
+public:
+    explicit PooledBuffer(size_t size) {
+        for (auto it = bufferPool.begin(); it != bufferPool.end(); ++it) {
+            if (it->size() >= size) {
+                buffer_ = std::move(*it);
+                bufferPool.erase(it);
+                break;
+            }
+        }
+        resize(size);
+    }
+    
+    ~PooledBuffer() {
+        if (buffer_.size() > BUFFER_POOL_MAX || bufferPool.size() >= BUFFER_POOL_SIZE) return;
+        try {
+            bufferPool.push_back(std::move(buffer_));
+        } catch (...) {
+        }
+    }
+    
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+    
+    // 调整可用大小, 底层缓冲区只增不减
+    void resize(size_t size) {
+        if (buffer_.size() < size) buffer_.resize(size);
+        size_ = size;
+    }
+    
+    uint8_t* data() { return buffer_.data(); }
+    size_t size() const { return size_; }
+    
+private:
+    std::vector<uint8_t> buffer_;
+    size_t size_ = 0;
+};
+
+// 写入std::ostream的输出端
+struct OstreamSink {
+    std::ostream& output;
+    
+    void operator()(const uint8_t* data, size_t size) {
+        output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+};
+
+// 流式压缩到std::ostream, 输出按outSize分块写入
+template <typename Source>
+static void deflateChunks(z_stream& stream, Source&& source, std::ostream& output, size_t outSize) {
+    PooledBuffer outBuf(outSize);
+    deflateChunksTo(stream, source, OstreamSink{output}, outBuf.data(), outBuf.size());
+}
+
+// 流式解压到std::ostream
+template <typename Source>
+static void inflateChunks(z_stream& stream, Source&& source, std::ostream& output, size_t outSize) {
+    PooledBuffer outBuf(outSize);
+    inflateChunksTo(stream, source, OstreamSink{output}, outBuf.data(), outBuf.size());
+}
+
+// 自适应读取的起始块大小、测量窗口 (块数) 与继续增长所需的吞吐量提升比例
+static constexpr size_t ADAPT_INITIAL_CHUNK = 64 * 1024;
+static constexpr unsigned ADAPT_WINDOW = 8;
+static constexpr double ADAPT_GAIN = 1.05;
+
+// 从输入流按块读取的数据源; buffer为空时从线程本地池租用缓冲区.
+// 自适应模式从较小的块开始, 每ADAPT_WINDOW块测量一次吞吐量 (含其间的压缩/解压耗时),
+// 仍在提升时把块大小加倍, 直到maxChunkSize或吞吐量不再提升
+class StreamSource {
+public:
+    StreamSource(std::istream& input, size_t chunkSize)
+        : StreamSource(input, chunkSize, nullptr, false) {}
+    
+    StreamSource(std::istream& input, size_t maxChunkSize, uint8_t* buffer, bool adaptive)
+        : input_(input),
+          external_(buffer),
+          chunkSize_(adaptive ? std::min(ADAPT_INITIAL_CHUNK, maxChunkSize) : maxChunkSize),
+          maxChunkSize_(maxChunkSize),
+          adaptive_(adaptive && chunkSize_ < maxChunkSize),
+          pooled_(buffer ? 0 : chunkSize_) {}
+    
+    size_t operator()(const uint8_t*& data) {
+        if (adaptive_) adapt();
+        
+        uint8_t* buffer = external_;
+        if (!buffer) {
+            pooled_.resize(chunkSize_);
+            buffer = pooled_.data();
+        }
+        input_.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(chunkSize_));
+        size_t size = static_cast<size_t>(input_.gcount());
+        windowBytes_ += size;
+        data = buffer;
+        return size;
+    }
+    
+private:
+    void adapt() {
+        auto now = std::chrono::steady_clock::now();
+        if (windowChunks_++ == 0) {
+            windowStart_ = now;
+            return;
+        }
+        if (windowChunks_ <= ADAPT_WINDOW) return;
+        
+        double seconds = std::chrono::duration<double>(now - windowStart_).count();
+        double rate = seconds > 0 ? windowBytes_ / seconds : std::numeric_limits<double>::infinity();
+        if (rate > lastRate_ * ADAPT_GAIN) {
+            lastRate_ = rate;
+            chunkSize_ = std::min(chunkSize_ * 2, maxChunkSize_);
+            adaptive_ = chunkSize_ < maxChunkSize_;
+        } else {
+            adaptive_ = false;
+        }
+        windowChunks_ = 1;
+        windowStart_ = now;
+        windowBytes_ = 0;
+    }
+    
+    std::istream& input_;
+    uint8_t* external_;
+    size_t chunkSize_;
+    size_t maxChunkSize_;
+    bool adaptive_;
+    PooledBuffer pooled_;
+    unsigned windowChunks_ = 0;
+    size_t windowBytes_ = 0;
+    double lastRate_ = 0;
+    std::chrono::steady_clock::time_point windowStart_;
+};
+
+// 内存数据源, 超大数据按MAX_CHUNK切片
+class MemorySource {
+public:
+    MemorySource(const uint8_t* data, size_t size)
+        : data_(data), remaining_(size) {}
+    
+    size_t operator()(const uint8_t*& data) {
+        size_t size = std::min(remaining_, MAX_CHUNK);
+        data = data_;
+        data_ += size;
+        remaining_ -= size;
+        return size;
+    }
+    
+private:
+    const uint8_t* data_;
+    size_t remaining_;
+};
+
+// 流式操作的默认块大小
+static constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024; // 64KB
+
+// 检查流式操作选项中的缓冲区大小
+static void checkStreamOptions(const Zip::StreamOptions& options) {
+    if (options.inputBufferSize == 0 || options.outputBufferSize == 0 ||
+        options.inputBufferSize > MAX_CHUNK || options.outputBufferSize > MAX_CHUNK) {
+        throw std::invalid_argument("Stream buffer size must be between 1 and " + std::to_string(MAX_CHUNK));
+    }
+}
+
+// === 内存分配器 ===
+
+// 全局默认分配器 (nullptr表示使用zlib内置的malloc/free)
+static std::atomic<Zip::Allocator*> defaultAllocator_{nullptr};
+
+static voidpf allocatorAlloc(voidpf opaque, uInt items, uInt size) {
+    try {
+        return static_cast<Zip::Allocator*>(opaque)->allocate(static_cast<size_t>(items) * size);
+    } catch (...) {
+        return Z_NULL;
+    }
+}
+
+static void allocatorFree(voidpf opaque, voidpf ptr) {
+    static_cast<Zip::Allocator*>(opaque)->deallocate(ptr);
+}
+
+// 在init之前把分配器挂到z_stream上
+static void installAllocator(z_stream& stream, Zip::Allocator* allocator) {
+    if (allocator == nullptr) return;
+    stream.zalloc = allocatorAlloc;
+    stream.zfree = allocatorFree;
+    stream.opaque = allocator;
+}
+
+void Zip::setDefaultAllocator(Allocator* allocator) {
+    defaultAllocator_.store(allocator, std::memory_order_release);
+    // 当前线程缓存中绑定旧分配器的上下文不再能被命中, 直接释放
+    trimContextCache();
+}
+
+Zip::Allocator* Zip::defaultAllocator() {
+    return defaultAllocator_.load(std::memory_order_acquire);
+}
+
+// 每块分配前的头部, 记录大小与所属规格, 保证返回地址16字节对齐
+namespace {
+struct alignas(16) BlockHeader {
+    size_t size;
+    size_t sizeClass;
+};
+
+void updatePeak(std::atomic<size_t>& peak, size_t value) {
+    size_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+} // namespace
+
+// 池分配器: 按2的幂划分规格, 每种规格从固定大小的slab中切出等长槽位
+struct Zip::PoolAllocator::Impl {
+    static constexpr size_t MIN_SHIFT = 6;    // 64B
+    static constexpr size_t MAX_SHIFT = 18;   // 256KB
+    static constexpr size_t CLASS_COUNT = MAX_SHIFT - MIN_SHIFT + 1;
+    static constexpr size_t LARGE = CLASS_COUNT;
+    
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<void*> freeSlots;
+    };
+    
+    size_t slabSize;
+    std::array<SizeClass, CLASS_COUNT> classes;
+    std::mutex slabMutex;
+    std::vector<void*> slabs;
+    
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> bytesAllocated{0};
+    std::atomic<size_t> bytesInUse{0};
+    std::atomic<size_t> peakBytesInUse{0};
+    std::atomic<size_t> bytesReserved{0};
+    
+    static size_t classOf(size_t size) {
+        size_t shift = MIN_SHIFT;
+        while (shift <= MAX_SHIFT && (size_t(1) << shift) < size) ++shift;
+        return shift - MIN_SHIFT;
+    }
+    
+    static size_t slotSize(size_t sizeClass) {
+        return sizeof(BlockHeader) + (size_t(1) << (sizeClass + MIN_SHIFT));
+    }
+    
+    // 新申请一个slab并切分成该规格的空闲槽位 (调用方持有该规格的锁)
+    void refill(size_t sizeClass) {
+        size_t slot = slotSize(sizeClass);
+        size_t count = std::max<size_t>(slabSize / slot, 1);
+        void* slab = std::malloc(slot * count);
+        if (slab == nullptr) return;
+        {
+            std::lock_guard<std::mutex> lock(slabMutex);
+            slabs.push_back(slab);
+        }
+        bytesReserved += slot * count;
+        
+        auto& freeSlots = classes[sizeClass].freeSlots;
+        for (size_t i = count; i > 0; --i) {
+            freeSlots.push_back(static_cast<uint8_t*>(slab) + (i - 1) * slot);
+        }
+    }
+};
+
+Zip::PoolAllocator::PoolAllocator(size_t slabSize)
+    : impl_(new Impl) {
+    impl_->slabSize = slabSize;
+}
+
+Zip::PoolAllocator::~PoolAllocator() {
+    for (void* slab : impl_->slabs) std::free(slab);
+}
+
+void* Zip::PoolAllocator::allocate(size_t size) {
+    size_t sizeClass = Impl::classOf(size);
+    void* block = nullptr;
+    
+    if (sizeClass == Impl::LARGE) {
+        // 超过最大规格的请求直接走malloc
+        block = std::malloc(sizeof(BlockHeader) + size);
+    } else {
+        auto& cls = impl_->classes[sizeClass];
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        if (cls.freeSlots.empty()) impl_->refill(sizeClass);
+        if (!cls.freeSlots.empty()) {
+            block = cls.freeSlots.back();
+            cls.freeSlots.pop_back();
+        }
+    }
+    if (block == nullptr) return nullptr;
+    
+    auto* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->sizeClass = sizeClass;
+    
+    impl_->allocations.fetch_add(1, std::memory_order_relaxed);
+    impl_->bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    updatePeak(impl_->peakBytesInUse, impl_->bytesInUse.fetch_add(size, std::memory_order_relaxed) + size);
+    return header + 1;
+}
+
+void Zip::PoolAllocator::deallocate(void* ptr) {
+    if (ptr == nullptr) return;
+    
+    auto* header = static_cast<BlockHeader*>(ptr) - 1;
+    impl_->bytesInUse.fetch_sub(header->size, std::memory_order_relaxed);
+    
+    if (header->sizeClass == Impl::LARGE) {
+        std::free(header);
+        return;
+    }
+    auto& cls = impl_->classes[header->sizeClass];
+    std::lock_guard<std::mutex> lock(cls.mutex);
+    cls.freeSlots.push_back(header);
+}
+
+Zip::Allocator::Stats Zip::PoolAllocator::stats() const {
+    Stats result;
+    result.allocations = impl_->allocations.load(std::memory_order_relaxed);
+    result.bytesAllocated = impl_->bytesAllocated.load(std::memory_order_relaxed);
+    result.bytesInUse = impl_->bytesInUse.load(std::memory_order_relaxed);
+    result.peakBytesInUse = impl_->peakBytesInUse.load(std::memory_order_relaxed);
+    result.bytesReserved = impl_->bytesReserved.load(std::memory_order_relaxed);
+    return result;
+}
+
+// 区域分配器: 在大块内存中顺序分配, 释放不归还, reset()时整体回收
+struct Zip::ArenaAllocator::Impl {
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+    
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current = 0;   // 正在使用的块
+    size_t offset = 0;    // 当前块内已用字节
+    Stats stats;
+};
+
+Zip::ArenaAllocator::ArenaAllocator(size_t blockSize)
+    : impl_(new Impl) {
+    impl_->blockSize = blockSize;
+}
+
+Zip::ArenaAllocator::~ArenaAllocator() {
+    for (auto& block : impl_->blocks) std::free(block.data);
+}
+
+void* Zip::ArenaAllocator::allocate(size_t size) {
+    constexpr size_t ALIGN = alignof(BlockHeader);
+    size_t need = sizeof(BlockHeader) + (size + ALIGN - 1) / ALIGN * ALIGN;
+    
+    // 当前块不够时依次尝试后续已有的块, 都不够再申请新块
+    while (impl_->current < impl_->blocks.size() &&
+           impl_->blocks[impl_->current].size - impl_->offset < need) {
+        ++impl_->current;
+        impl_->offset = 0;
+    }
+    if (impl_->current == impl_->blocks.size()) {
+        size_t blockSize = std::max(impl_->blockSize, need);
+        auto* data = static_cast<uint8_t*>(std::malloc(blockSize));
+        if (data == nullptr) return nullptr;
+        impl_->blocks.push_back({data, blockSize});
+        impl_->offset = 0;
+        impl_->stats.bytesReserved += blockSize;
+    }
+    
+    auto* header = reinterpret_cast<BlockHeader*>(impl_->blocks[impl_->current].data + impl_->offset);
+    impl_->offset += need;
+    header->size = size;
+    header->sizeClass = 0;
+    
+    auto& stats = impl_->stats;
+    stats.allocations++;
+    stats.bytesAllocated += size;
+    stats.bytesInUse += size;
+    stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+    return header + 1;
+}
+
+void Zip::ArenaAllocator::deallocate(void* ptr) {
+    if (ptr == nullptr) return;
+    impl_->stats.bytesInUse -= (static_cast<BlockHeader*>(ptr) - 1)->size;
+}
+
+void Zip::ArenaAllocator::reset() {
+    impl_->current = 0;
+    impl_->offset = 0;
+    impl_->stats.bytesInUse = 0;
+}
+
+Zip::Allocator::Stats Zip::ArenaAllocator::stats() const {
+    return impl_->stats;
+}
+
+// 内部一次性任务使用的deflate流 (不经过线程缓存)
+class DeflateState {
+public:
+    DeflateState(int level, int windowBits) {
+        installAllocator(stream_, Zip::defaultAllocator());
+        int err = deflateInit2(&stream_, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+        if (err != Z_OK) {
+            throw std::runtime_error("deflateInit failed: " + std::string(zError(err)));
+        }
+    }
+    
+    ~DeflateState() { deflateEnd(&stream_); }
+    
+    DeflateState(const DeflateState&) = delete;
+    DeflateState& operator=(const DeflateState&) = delete;
+    
+    z_stream& get() { return stream_; }
+    
+private:
+    z_stream stream_ = {};
+};
+
+// 内部一次性任务使用的inflate流 (不经过线程缓存)
+class InflateState {
+public:
+    explicit InflateState(int windowBits) {
+        installAllocator(stream_, Zip::defaultAllocator());
+        int err = inflateInit2(&stream_, windowBits);
+        if (err != Z_OK) {
+            throw std::runtime_error("inflateInit failed: " + std::string(zError(err)));
+        }
+    }
+    
+    ~InflateState() { inflateEnd(&stream_); }
+    
+    InflateState(const InflateState&) = delete;
+    InflateState& operator=(const InflateState&) = delete;
+    
+    z_stream& get() { return stream_; }
+    
+private:
+    z_stream stream_ = {};
+};
+
+// === inflateBack解压引擎 ===
+
+// inflateBack的上下文与32KB滑动窗口. inflateBack直接解码到窗口并经回调交出输出,
+// 省去inflate向输出缓冲区的拷贝; 它只处理原始deflate数据, zlib头与adler32校验由调用方完成
+class InflateBackState {
+public:
+    InflateBackState() : window_(1U << MAX_WBITS) {
+        installAllocator(stream_, Zip::defaultAllocator());
+        int err = inflateBackInit(&stream_, MAX_WBITS, window_.data());
+        if (err != Z_OK) {
+            throw std::runtime_error("inflateBackInit failed: " + std::string(zError(err)));
+        }
+    }
+    
+    ~InflateBackState() { inflateBackEnd(&stream_); }
+    
+    InflateBackState(const InflateBackState&) = delete;
+    InflateBackState& operator=(const InflateBackState&) = delete;
+    
+    z_stream& get() { return stream_; }
+    
+private:
+    PooledBuffer window_;
+    z_stream stream_ = {};
+};
+
+// 整流解压 (不需要增量输出时可用): 解析zlib头后由inflateBack解码, 输出按窗口分块交给sink,
+// 最后核对adler32; 串接的成员依次解压. source与sink约定同inflateChunksTo, 回调中的异常在inflateBack返回后重新抛出
+template <typename Source, typename Sink>
+static void inflateBackTo(Source&& source, Sink&& sink) {
+    struct Context {
+        Source& source;
+        Sink& sink;
+        const uint8_t* next;
+        size_t avail;
+        uLong adler;
+        std::exception_ptr error;
+        
+        // 取一个输入字节, 输入结束时返回-1
+        int byte() {
+            if (avail == 0 && (avail = source(next)) == 0) return -1;
+            --avail;
+            return *next++;
+        }
+    } context{source, sink, nullptr, 0, adler32(0, Z_NULL, 0), nullptr};
+    
+    in_func in = [](void* desc, z_const unsigned char** buffer) -> unsigned {
+        Context& c = *static_cast<Context*>(desc);
+        try {
+            const uint8_t* data = nullptr;
+            size_t size = c.source(data);
+            *buffer = const_cast<unsigned char*>(data);
+            return static_cast<unsigned>(size);
+        } catch (...) {
+            c.error = std::current_exception();
+            return 0;
+        }
+    };
+    out_func out = [](void* desc, unsigned char* data, unsigned size) -> int {
+        Context& c = *static_cast<Context*>(desc);
+        try {
+            c.adler = adler32(c.adler, data, size);
+            c.sink(data, size);
+            return 0;
+        } catch (...) {
+            c.error = std::current_exception();
+            return 1;
+        }
+    };
+    
+    // inflateBack每次调用都重新开始, 同一上下文可用于所有成员
+    InflateBackState state;
+    z_stream& stream = state.get();
+    
+    // 串接的成员依次解压, 第一个成员之后输入结束即完成
+    for (bool first = true;; first = false) {
+        int cmf = context.byte();
+        if (cmf < 0 && !first) return;
+        int flg = context.byte();
+        if (flg < 0) throw std::runtime_error("Decompression incomplete");
+        if ((cmf & 0x0f) != Z_DEFLATED || (cmf >> 4) + 8 > MAX_WBITS || ((cmf << 8) | flg) % 31 != 0) {
+            throw std::runtime_error("Decompression error: " + std::string(zError(Z_DATA_ERROR)));
+        }
+        if (flg & 0x20) throw std::runtime_error("Decompression error: " + std::string(zError(Z_NEED_DICT)));
+        
+        stream.next_in = const_cast<Bytef*>(context.next);
+        stream.avail_in = static_cast<uInt>(context.avail);
+        context.adler = adler32(0, Z_NULL, 0);
+        
+        int ret = inflateBack(&stream, in, &context, out, &context);
+        if (context.error) std::rethrow_exception(context.error);
+        if (ret == Z_BUF_ERROR) throw std::runtime_error("Decompression incomplete");
+        if (ret != Z_STREAM_END) throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+        
+        // 剩余输入从adler32 (大端) 开始
+        context.next = stream.next_in;
+        context.avail = stream.next_in ? stream.avail_in : 0;
+        uLong check = 0;
+        for (int i = 0; i < 4; ++i) {
+            int b = context.byte();
+            if (b < 0) throw std::runtime_error("Decompression incomplete");
+            check = (check << 8) | static_cast<uLong>(b);
+        }
+        if (check != context.adler) {
+            throw std::runtime_error("Decompression error: " + std::string(zError(Z_DATA_ERROR)));
+        }
+    }
+}
+
+// === 刷新策略 ===
+
+// 刷新模式对应的deflate flush参数
+static int zlibFlush(Zip::FlushMode mode) {
+    switch (mode) {
+    case Zip::FlushMode::Full: return Z_FULL_FLUSH;
+    case Zip::FlushMode::Partial: return Z_PARTIAL_FLUSH;
+    default: return Z_SYNC_FLUSH;
+    }
+}
+
+// 自动刷新的计数与计时: 记录未刷新的输入字节数及其中第一个字节到达的时间
+class FlushClock {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    explicit FlushClock(const Zip::FlushPolicy& policy = Zip::FlushPolicy()) : policy_(policy) {}
+    
+    void add(size_t bytes) {
+        if (bytes == 0) return;
+        if (pending_ == 0) first_ = Clock::now();
+        pending_ += bytes;
+    }
+    
+    bool due() const {
+        if (pending_ == 0) return false;
+        if (policy_.everyBytes > 0 && pending_ >= policy_.everyBytes) return true;
+        return timed() && Clock::now() >= deadline();
+    }
+    
+    void setPolicy(const Zip::FlushPolicy& policy) { policy_ = policy; }
+    bool pending() const { return pending_ > 0; }
+    bool timed() const { return policy_.everyMilliseconds > 0; }
+    Clock::time_point deadline() const { return first_ + std::chrono::milliseconds(policy_.everyMilliseconds); }
+    int flush() const { return zlibFlush(policy_.mode); }
+    void reset() { pending_ = 0; }
+    
+private:
+    Zip::FlushPolicy policy_;
+    size_t pending_ = 0;
+    Clock::time_point first_;
+};
+
+// 按自动刷新策略流式压缩 (定义见流水线压缩部分)
+static void deflateAutoFlush(z_stream& stream, std::istream& input, std::ostream& output,
+                             const Zip::FlushPolicy& policy, size_t inSize, size_t outSize);
+
+// === Compressor ===
+
+struct Zip::Compressor::Impl {
+    z_stream stream = {};
+    bool used = false;
+    
+    // 复用前重置流状态, 保留已分配的内部缓冲区
+    z_stream& acquire() {
+        if (used) deflateReset(&stream);
+        used = true;
+        return stream;
+    }
+};
+
+Zip::Compressor::Compressor(int level, int windowBits, int memLevel, int strategy,
+                            Allocator* allocator)
+    : impl_(new Impl) {
+    checkLevel(level);
+    
+    installAllocator(impl_->stream, allocator ? allocator : defaultAllocator());
+    int err = deflateInit2(&impl_->stream, level, Z_DEFLATED, windowBits, memLevel, strategy);
+    if (err != Z_OK) {
+        throw std::runtime_error("deflateInit failed: " + std::string(zError(err)));
+    }
+}
+
+Zip::Compressor::~Compressor() {
+    if (impl_) deflateEnd(&impl_->stream);
+}
+
+Zip::Compressor::Compressor(Compressor&&) noexcept = default;
+
+Zip::Compressor& Zip::Compressor::operator=(Compressor&& other) noexcept {
+    if (this != &other) {
+        if (impl_) deflateEnd(&impl_->stream);
+        impl_ = std::move(other.impl_);
+    }
+    return *this;
+}
+
+std::vector<uint8_t> Zip::Compressor::compress(const std::vector<uint8_t>& data) {
     if (data.empty()) return {};
     
-    // 验证压缩级别
-    if (level < 0 || level > 9) {
-        throw std::invalid_argument("Compression level must be between 0 and 9");
+    // 按最大压缩大小分配, 压缩后截断; 由deflateBound按实际的windowBits (zlib/gzip/raw) 计算
+    z_stream& stream = impl_->acquire();
+    size_t bound = data.size() <= std::numeric_limits<uLong>::max() / 2
+        ? deflateBound(&stream, static_cast<uLong>(data.size()))
+        : Zip::compressBound(data.size()) + 12;  // gzip头尾共18字节, 比zlib多12字节
+    std::vector<uint8_t> result(bound);
+    result.resize(deflateInto(stream, data.data(), data.size(), result.data(), result.size()));
+    return result;
+}
+
+size_t Zip::Compressor::compress(const uint8_t* data, size_t size, uint8_t* output,
+                                 size_t outputCapacity) {
+    if (size == 0) return 0;
+    return deflateInto(impl_->acquire(), data, size, output, outputCapacity);
+}
+
+void Zip::Compressor::compress(const uint8_t* data, size_t size, std::ostream& output) {
+    if (size == 0) return;
+    deflateChunks(impl_->acquire(), MemorySource(data, size), output, 4 * STREAM_CHUNK_SIZE);
+}
+
+void Zip::Compressor::compressStream(std::istream& input, std::ostream& output) {
+    deflateChunks(impl_->acquire(), StreamSource(input, STREAM_CHUNK_SIZE), output, 2 * STREAM_CHUNK_SIZE);
+}
+
+void Zip::Compressor::compressStream(std::istream& input, std::ostream& output, const StreamOptions& options) {
+    checkStreamOptions(options);
+    if (options.autoFlush.enabled()) {
+        deflateAutoFlush(impl_->acquire(), input, output, options.autoFlush,
+                         options.inputBufferSize, options.outputBufferSize);
+        return;
+    }
+    PooledBuffer pooled(options.outputBuffer ? 0 : options.outputBufferSize);
+    uint8_t* outBuf = options.outputBuffer ? options.outputBuffer : pooled.data();
+    deflateChunksTo(impl_->acquire(),
+                    StreamSource(input, options.inputBufferSize, options.inputBuffer, options.adaptive),
+                    OstreamSink{output}, outBuf, options.outputBufferSize);
+}
+
+// === Decompressor ===
+
+struct Zip::Decompressor::Impl {
+    z_stream stream = {};
+    bool used = false;
+    
+    // 复用前重置流状态, 保留已分配的滑动窗口
+    z_stream& acquire() {
+        if (used) inflateReset(&stream);
+        used = true;
+        return stream;
+    }
+};
+
+Zip::Decompressor::Decompressor(int windowBits, Allocator* allocator)
+    : impl_(new Impl) {
+    installAllocator(impl_->stream, allocator ? allocator : defaultAllocator());
+    int err = inflateInit2(&impl_->stream, windowBits);
+    if (err != Z_OK) {
+        throw std::runtime_error("inflateInit failed: " + std::string(zError(err)));
+    }
+}
+
+Zip::Decompressor::~Decompressor() {
+    if (impl_) inflateEnd(&impl_->stream);
+}
+
+Zip::Decompressor::Decompressor(Decompressor&&) noexcept = default;
+
+Zip::Decompressor& Zip::Decompressor::operator=(Decompressor&& other) noexcept {
+    if (this != &other) {
+        if (impl_) inflateEnd(&impl_->stream);
+        impl_ = std::move(other.impl_);
+    }
+    return *this;
+}
+
+std::vector<uint8_t> Zip::Decompressor::decompress(const std::vector<uint8_t>& compressed) {
+    return decompress(compressed, 0, SIZE_MAX);
+}
+
+std::vector<uint8_t> Zip::Decompressor::decompress(const std::vector<uint8_t>& compressed,
+                                                   size_t expectedSize, size_t maxOutputSize) {
+    if (compressed.empty()) return {};
+    
+    // 已知原始大小时一次精确分配; 未知(0)时按2倍估计, 不足时在同一个流上继续扩容
+    size_t initialCapacity = expectedSize > 0 ? expectedSize : compressed.size() * 2;
+    std::vector<uint8_t> result;
+    inflateGrowing(impl_->acquire(), compressed.data(), compressed.size(),
+                   initialCapacity, maxOutputSize, result);
+    return result;
+}
+
+size_t Zip::Decompressor::decompress(const uint8_t* compressed, size_t size, uint8_t* output,
+                                     size_t outputCapacity) {
+    if (size == 0) return 0;
+    return inflateInto(impl_->acquire(), compressed, size, output, outputCapacity);
+}
+
+void Zip::Decompressor::decompress(const uint8_t* compressed, size_t size, std::ostream& output) {
+    if (size == 0) return;
+    inflateChunks(impl_->acquire(), MemorySource(compressed, size), output, 4 * STREAM_CHUNK_SIZE);
+}
+
+void Zip::Decompressor::decompressStream(std::istream& input, std::ostream& output) {
+    inflateChunks(impl_->acquire(), StreamSource(input, STREAM_CHUNK_SIZE), output, 2 * STREAM_CHUNK_SIZE);
+}
+
+void Zip::Decompressor::decompressStream(std::istream& input, std::ostream& output,
+                                         const StreamOptions& options) {
+    checkStreamOptions(options);
+    PooledBuffer pooled(options.outputBuffer ? 0 : options.outputBufferSize);
+    uint8_t* outBuf = options.outputBuffer ? options.outputBuffer : pooled.data();
+    inflateChunksTo(impl_->acquire(),
+                    StreamSource(input, options.inputBufferSize, options.inputBuffer, options.adaptive),
+                    OstreamSink{output}, outBuf, options.outputBufferSize);
+}
+
+// === 流缓冲区适配器 ===
+
+// 检查流缓冲区大小
+static size_t checkBufferSize(size_t bufferSize) {
+    if (bufferSize == 0) throw std::invalid_argument("Buffer size must be positive");
+    // pbump/gbump的偏移为int
+    return std::min(bufferSize, static_cast<size_t>(std::numeric_limits<int>::max()));
+}
+
+struct Zip::DeflateStreamBuf::Impl {
+    Impl(std::ostream& output, int level, size_t bufferSize)
+        : output(output), deflater(level, MAX_WBITS), input(bufferSize), out(bufferSize) {
+        deflater.get().next_out = out.data();
+        deflater.get().avail_out = static_cast<uInt>(out.size());
+    }
+    
+    // 压缩data, 输出攒满缓冲区才写入下游; flush不为Z_NO_FLUSH时写出全部输出
+    void deflateData(const char* data, size_t size, int flush) {
+        z_stream& stream = deflater.get();
+        if (size > 0) unflushed = true;
+        do {
+            size_t chunk = std::min(size, MAX_CHUNK);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            stream.avail_in = static_cast<uInt>(chunk);
+            data += chunk;
+            size -= chunk;
+            
+            int mode = size == 0 ? flush : Z_NO_FLUSH;
+            for (;;) {
+                int err = deflate(&stream, mode);
+                if (err == Z_STREAM_ERROR) {
+                    throw std::runtime_error("Compression error: " + std::string(zError(err)));
+                }
+                if (stream.avail_out > 0) break;
+                writeOut(out.size());
+            }
+        } while (size > 0);
+        
+        if (flush != Z_NO_FLUSH) {
+            writeOut(out.size() - stream.avail_out);
+            unflushed = false;
+            clock.reset();
+        }
+    }
+    
+    // 把放置区中新写入的字节计入刷新条件
+    void count(size_t buffered) {
+        clock.add(buffered - counted);
+        counted = buffered;
+    }
+    
+    void writeOut(size_t size) {
+        if (size > 0 && !output.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Failed to write output stream");
+        }
+        deflater.get().next_out = out.data();
+        deflater.get().avail_out = static_cast<uInt>(out.size());
+    }
+    
+    std::ostream& output;
+    DeflateState deflater;
+    std::vector<char> input;
+    std::vector<uint8_t> out;
+    bool unflushed = false;     // 自上次同步刷新后是否压缩过数据
+    bool finished = false;
+    FlushClock clock;
+    size_t counted = 0;         // 放置区中已计入clock的字节数
+};
+
+Zip::DeflateStreamBuf::DeflateStreamBuf(std::ostream& output, int level, size_t bufferSize) {
+    checkLevel(level);
+    impl_.reset(new Impl(output, level, checkBufferSize(bufferSize)));
+    setp(impl_->input.data(), impl_->input.data() + impl_->input.size());
+}
+
+Zip::DeflateStreamBuf::~DeflateStreamBuf() {
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+
+void Zip::DeflateStreamBuf::finish() {
+    if (impl_->finished) return;
+    impl_->finished = true;
+    
+    size_t pending = static_cast<size_t>(pptr() - pbase());
+    setp(nullptr, nullptr);
+    impl_->deflateData(impl_->input.data(), pending, Z_FINISH);
+    if (!impl_->output.flush()) throw std::runtime_error("Failed to write output stream");
+}
+
+void Zip::DeflateStreamBuf::setFlushPolicy(const FlushPolicy& policy) {
+    impl_->clock.setPolicy(policy);
+}
+
+// 满足自动刷新条件时以策略的模式刷新放置区与zlib中的数据, 并刷新下游
+void Zip::DeflateStreamBuf::flushIfDue() {
+    impl_->count(static_cast<size_t>(pptr() - pbase()));
+    if (!impl_->clock.due()) return;
+    
+    impl_->deflateData(pbase(), static_cast<size_t>(pptr() - pbase()), impl_->clock.flush());
+    setp(impl_->input.data(), impl_->input.data() + impl_->input.size());
+    impl_->counted = 0;
+    if (!impl_->output.flush()) throw std::runtime_error("Failed to write output stream");
+}
+
+Zip::DeflateStreamBuf::int_type Zip::DeflateStreamBuf::overflow(int_type ch) {
+    if (impl_->finished) return traits_type::eof();
+    
+    impl_->count(static_cast<size_t>(pptr() - pbase()));
+    impl_->deflateData(pbase(), static_cast<size_t>(pptr() - pbase()), Z_NO_FLUSH);
+    setp(impl_->input.data(), impl_->input.data() + impl_->input.size());
+    impl_->counted = 0;
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    flushIfDue();
+    return traits_type::not_eof(ch);
+}
+
+// 放不下缓冲区的大块写入直接压缩调用方数据, 省去拷贝
+std::streamsize Zip::DeflateStreamBuf::xsputn(const char_type* data, std::streamsize count) {
+    if (impl_->finished || count <= 0) return 0;
+    
+    if (count < epptr() - pptr()) {
+        std::memcpy(pptr(), data, static_cast<size_t>(count));
+        pbump(static_cast<int>(count));
+        flushIfDue();
+        return count;
+    }
+    
+    impl_->count(static_cast<size_t>(pptr() - pbase()));
+    impl_->deflateData(pbase(), static_cast<size_t>(pptr() - pbase()), Z_NO_FLUSH);
+    impl_->clock.add(static_cast<size_t>(count));
+    impl_->deflateData(data, static_cast<size_t>(count), Z_NO_FLUSH);
+    setp(impl_->input.data(), impl_->input.data() + impl_->input.size());
+    impl_->counted = 0;
+    flushIfDue();
+    return count;
+}
+
+int Zip::DeflateStreamBuf::sync() {
+    if (impl_->finished) return 0;
+    
+    try {
+        if (pptr() > pbase() || impl_->unflushed) {
+            impl_->deflateData(pbase(), static_cast<size_t>(pptr() - pbase()), impl_->clock.flush());
+            setp(impl_->input.data(), impl_->input.data() + impl_->input.size());
+            impl_->counted = 0;
+        }
+        return impl_->output.flush() ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
+
+struct Zip::InflateStreamBuf::Impl {
+    Impl(std::istream& input, size_t bufferSize)
+        : input(input), inflater(MAX_WBITS), in(bufferSize), out(bufferSize) {}
+    
+    // 解压到[dest, dest + size), 返回产出的字节数, 0表示zlib流已结束
+    size_t inflateData(char* dest, size_t size) {
+        z_stream& stream = inflater.get();
+        uInt capacity = static_cast<uInt>(std::min(size, MAX_CHUNK));
+        stream.next_out = reinterpret_cast<Bytef*>(dest);
+        stream.avail_out = capacity;
+        
+        while (!ended && stream.avail_out == capacity) {
+            if (stream.avail_in == 0) {
+                input.read(reinterpret_cast<char*>(in.data()), static_cast<std::streamsize>(in.size()));
+                size_t got = static_cast<size_t>(input.gcount());
+                if (got == 0) throw std::runtime_error("Decompression incomplete");
+                stream.next_in = in.data();
+                stream.avail_in = static_cast<uInt>(got);
+            }
+            
+            int ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+                ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+            }
+            if (ret == Z_STREAM_END) ended = true;
+        }
+        return capacity - stream.avail_out;
+    }
+    
+    std::istream& input;
+    InflateState inflater;
+    std::vector<uint8_t> in;
+    std::vector<char> out;
+    bool ended = false;
+};
+
+Zip::InflateStreamBuf::InflateStreamBuf(std::istream& input, size_t bufferSize)
+    : impl_(new Impl(input, checkBufferSize(bufferSize))) {}
+
+Zip::InflateStreamBuf::~InflateStreamBuf() = default;
+
+Zip::InflateStreamBuf::int_type Zip::InflateStreamBuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    
+    size_t size = impl_->inflateData(impl_->out.data(), impl_->out.size());
+    if (size == 0) return traits_type::eof();
+    setg(impl_->out.data(), impl_->out.data(), impl_->out.data() + size);
+    return traits_type::to_int_type(*gptr());
+}
+
+// 先取走已解压的数据, 剩余需求不小于缓冲区时直接解压到调用方内存
+std::streamsize Zip::InflateStreamBuf::xsgetn(char_type* data, std::streamsize count) {
+    std::streamsize total = 0;
+    while (total < count) {
+        std::streamsize available = egptr() - gptr();
+        if (available > 0) {
+            std::streamsize n = std::min(available, count - total);
+            std::memcpy(data + total, gptr(), static_cast<size_t>(n));
+            gbump(static_cast<int>(n));
+            total += n;
+        } else if (static_cast<size_t>(count - total) >= impl_->out.size()) {
+            size_t n = impl_->inflateData(data + total, static_cast<size_t>(count - total));
+            if (n == 0) break;
+            total += static_cast<std::streamsize>(n);
+        } else if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+            break;
+        }
+    }
+    return total;
+}
+
+Zip::DeflateOStream::DeflateOStream(std::ostream& output, int level, size_t bufferSize)
+    : std::ostream(nullptr), buffer_(output, level, bufferSize) {
+    rdbuf(&buffer_);
+}
+
+void Zip::DeflateOStream::finish() {
+    try {
+        buffer_.finish();
+    } catch (...) {
+        setstate(std::ios::badbit);
+        throw;
+    }
+}
+
+Zip::InflateIStream::InflateIStream(std::istream& input, size_t bufferSize)
+    : std::istream(nullptr), buffer_(input, bufferSize) {
+    rdbuf(&buffer_);
+}
+
+// === 推送式增量接口 ===
+
+// 把输入和输出空间按uInt范围分段交给step(stream, flush)推进, 直到输入耗尽、输出写满或流结束;
+// 只有最后一段输入使用flush. step返回zlib的结果码
+template <typename Step>
+static Zip::Progress advanceStream(z_stream& stream, const uint8_t* input, size_t size,
+                                   uint8_t* output, size_t capacity, int flush, Step&& step) {
+    Zip::Progress progress;
+    for (;;) {
+        size_t inChunk = std::min(size - progress.consumed, MAX_CHUNK);
+        size_t outChunk = std::min(capacity - progress.produced, MAX_CHUNK);
+        bool lastInput = inChunk == size - progress.consumed;
+        stream.next_in = const_cast<Bytef*>(input + progress.consumed);
+        stream.avail_in = static_cast<uInt>(inChunk);
+        stream.next_out = output + progress.produced;
+        stream.avail_out = static_cast<uInt>(outChunk);
+        
+        int ret = step(stream, lastInput ? flush : Z_NO_FLUSH);
+        progress.consumed += inChunk - stream.avail_in;
+        progress.produced += outChunk - stream.avail_out;
+        
+        if (ret == Z_STREAM_END) {
+            progress.done = true;
+            break;
+        }
+        // 输出写满: 还有输出空间时继续, 否则交还调用方
+        if (stream.avail_out == 0) {
+            if (progress.produced == capacity) break;
+            continue;
+        }
+        // 输出未满说明本段输入已处理完 (flush也已完成)
+        if (!lastInput) continue;
+        progress.done = true;
+        break;
+    }
+    return progress;
+}
+
+// 反复调用step(consumed, output, capacity)把输出追加到vector末尾, 直到完成或不再受输出空间限制
+template <typename Step>
+static Zip::Progress appendOutput(std::vector<uint8_t>& output, Step&& step) {
+    Zip::Progress total;
+    for (;;) {
+        size_t offset = output.size();
+        output.resize(offset + STREAM_CHUNK_SIZE);
+        Zip::Progress progress = step(total.consumed, output.data() + offset, STREAM_CHUNK_SIZE);
+        output.resize(offset + progress.produced);
+        
+        total.consumed += progress.consumed;
+        total.produced += progress.produced;
+        total.done = progress.done;
+        if (progress.done || progress.produced < STREAM_CHUNK_SIZE) break;
+    }
+    return total;
+}
+
+struct Zip::DeflateStream::Impl {
+    z_stream stream = {};
+    FlushClock clock;
+    bool flushing = false;      // 自动刷新因输出空间不足尚未完成
+    
+    Progress run(const uint8_t* input, size_t size, uint8_t* output, size_t capacity, int flush) {
+        return advanceStream(stream, input, size, output, capacity, flush, [](z_stream& s, int mode) {
+            int err = deflate(&s, mode);
+            if (err == Z_STREAM_ERROR) {
+                throw std::runtime_error("Compression error: " + std::string(zError(err)));
+            }
+            return err;
+        });
+    }
+};
+
+Zip::DeflateStream::DeflateStream(int level, int windowBits, int memLevel, int strategy,
+                                  Allocator* allocator)
+    : impl_(new Impl) {
+    checkLevel(level);
+    
+    installAllocator(impl_->stream, allocator ? allocator : defaultAllocator());
+    int err = deflateInit2(&impl_->stream, level, Z_DEFLATED, windowBits, memLevel, strategy);
+    if (err != Z_OK) {
+        throw std::runtime_error("deflateInit failed: " + std::string(zError(err)));
+    }
+}
+
+Zip::DeflateStream::~DeflateStream() {
+    if (impl_) deflateEnd(&impl_->stream);
+}
+
+Zip::DeflateStream::DeflateStream(DeflateStream&&) noexcept = default;
+
+Zip::DeflateStream& Zip::DeflateStream::operator=(DeflateStream&& other) noexcept {
+    if (this != &other) {
+        if (impl_) deflateEnd(&impl_->stream);
+        impl_ = std::move(other.impl_);
+    }
+    return *this;
+}
+
+// 输入全部消耗即完成; 压缩结果可能暂存在zlib内部, 由后续feed/flush/finish交出.
+// 未完成的自动刷新先于新输入继续进行 (zlib要求以相同的flush参数完成)
+Zip::Progress Zip::DeflateStream::feed(const uint8_t* input, size_t size, uint8_t* output, size_t capacity) {
+    Progress progress;
+    if (!impl_->flushing) {
+        progress = impl_->run(input, size, output, capacity, Z_NO_FLUSH);
+        impl_->clock.add(progress.consumed);
+        if (progress.consumed < size || !impl_->clock.due()) {
+            progress.done = progress.consumed == size;
+            return progress;
+        }
+    }
+    
+    Progress flushed = impl_->run(nullptr, 0, output + progress.produced, capacity - progress.produced,
+                                  impl_->clock.flush());
+    progress.produced += flushed.produced;
+    impl_->flushing = !flushed.done;
+    if (flushed.done) impl_->clock.reset();
+    
+    // 刷新完成后再处理flushing期间传入的输入
+    if (flushed.done && progress.consumed < size) {
+        Progress rest = feed(input + progress.consumed, size - progress.consumed,
+                             output + progress.produced, capacity - progress.produced);
+        progress.consumed += rest.consumed;
+        progress.produced += rest.produced;
+        progress.done = rest.done;
+        return progress;
+    }
+    progress.done = flushed.done && progress.consumed == size;
+    return progress;
+}
+
+Zip::Progress Zip::DeflateStream::flush(uint8_t* output, size_t capacity, FlushMode mode) {
+    Progress progress = impl_->run(nullptr, 0, output, capacity, zlibFlush(mode));
+    if (progress.done) {
+        impl_->clock.reset();
+        impl_->flushing = false;
+    }
+    return progress;
+}
+
+Zip::Progress Zip::DeflateStream::finish(uint8_t* output, size_t capacity) {
+    return impl_->run(nullptr, 0, output, capacity, Z_FINISH);
+}
+
+Zip::Progress Zip::DeflateStream::feed(const uint8_t* input, size_t size, std::vector<uint8_t>& output) {
+    return appendOutput(output, [&](size_t consumed, uint8_t* out, size_t capacity) {
+        return feed(input + consumed, size - consumed, out, capacity);
+    });
+}
+
+Zip::Progress Zip::DeflateStream::flush(std::vector<uint8_t>& output, FlushMode mode) {
+    return appendOutput(output, [&](size_t, uint8_t* out, size_t capacity) { return flush(out, capacity, mode); });
+}
+
+Zip::Progress Zip::DeflateStream::finish(std::vector<uint8_t>& output) {
+    return appendOutput(output, [&](size_t, uint8_t* out, size_t capacity) { return finish(out, capacity); });
+}
+
+void Zip::DeflateStream::setFlushPolicy(const FlushPolicy& policy) {
+    impl_->clock.setPolicy(policy);
+}
+
+bool Zip::DeflateStream::flushDue() const {
+    return impl_->flushing || impl_->clock.due();
+}
+
+void Zip::DeflateStream::reset() {
+    deflateReset(&impl_->stream);
+    impl_->clock.reset();
+    impl_->flushing = false;
+}
+
+struct Zip::InflateStream::Impl {
+    z_stream stream = {};
+    bool finished = false;
+};
+
+Zip::InflateStream::InflateStream(int windowBits, Allocator* allocator)
+    : impl_(new Impl) {
+    installAllocator(impl_->stream, allocator ? allocator : defaultAllocator());
+    int err = inflateInit2(&impl_->stream, windowBits);
+    if (err != Z_OK) {
+        throw std::runtime_error("inflateInit failed: " + std::string(zError(err)));
+    }
+}
+
+Zip::InflateStream::~InflateStream() {
+    if (impl_) inflateEnd(&impl_->stream);
+}
+
+Zip::InflateStream::InflateStream(InflateStream&&) noexcept = default;
+
+Zip::InflateStream& Zip::InflateStream::operator=(InflateStream&& other) noexcept {
+    if (this != &other) {
+        if (impl_) inflateEnd(&impl_->stream);
+        impl_ = std::move(other.impl_);
+    }
+    return *this;
+}
+
+// 输入耗尽而流未结束时done为false, 等待更多输入; 输出写满时以剩余输入再次调用
+Zip::Progress Zip::InflateStream::feed(const uint8_t* input, size_t size, uint8_t* output, size_t capacity) {
+    if (impl_->finished) {
+        Progress progress;
+        progress.done = true;
+        return progress;
+    }
+    
+    bool& finished = impl_->finished;
+    Progress progress = advanceStream(impl_->stream, input, size, output, capacity, Z_NO_FLUSH,
+        [&finished](z_stream& s, int mode) {
+            int ret = inflate(&s, mode);
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+                ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+            }
+            if (ret == Z_STREAM_END) finished = true;
+            return ret;
+        });
+    progress.done = finished;
+    return progress;
+}
+
+Zip::Progress Zip::InflateStream::feed(const uint8_t* input, size_t size, std::vector<uint8_t>& output) {
+    return appendOutput(output, [&](size_t consumed, uint8_t* out, size_t capacity) {
+        return feed(input + consumed, size - consumed, out, capacity);
+    });
+}
+
+bool Zip::InflateStream::finished() const {
+    return impl_->finished;
+}
+
+void Zip::InflateStream::reset() {
+    inflateReset(&impl_->stream);
+    impl_->finished = false;
+}
+
+// === 线程本地上下文缓存 ===
+
+// 每个线程每种上下文缓存的数量上限
+static std::atomic<size_t> contextCacheMax{8};
+
+// 按初始化参数索引的上下文缓存, 最近使用的位于尾部
+template <typename Context>
+class ContextCache {
+public:
+    // 初始化参数 + 分配器
+    using Key = std::tuple<int, int, int, int, Zip::Allocator*>;
+    
+    // 取出参数匹配的上下文, 没有则新建 (取出后其他调用者不会共用)
+    template <typename Factory>
+    Context take(const Key& key, Factory make) {
+        for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+            if (it->first == key) {
+                Context ctx = std::move(it->second);
+                entries_.erase(std::next(it).base());
+                return ctx;
+            }
+        }
+        return make();
+    }
+    
+    // 归还上下文, 超出上限时淘汰最久未使用的
+    void give(const Key& key, Context&& ctx) {
+        size_t limit = contextCacheMax.load(std::memory_order_relaxed);
+        if (limit == 0) return;
+        entries_.emplace_back(key, std::move(ctx));
+        trim(limit);
+    }
+    
+    void trim(size_t keep) {
+        if (entries_.size() > keep) {
+            entries_.erase(entries_.begin(), entries_.end() - keep);
+        }
+    }
+    
+private:
+    std::vector<std::pair<Key, Context>> entries_;
+};
+
+// 借出的上下文, 析构时归还缓存
+template <typename Context>
+class CachedContext {
+public:
+    using Key = typename ContextCache<Context>::Key;
+    
+    CachedContext(ContextCache<Context>& cache, const Key& key, Context&& ctx)
+        : cache_(cache), key_(key), ctx_(std::move(ctx)) {}
+    
+    ~CachedContext() {
+        try {
+            cache_.give(key_, std::move(ctx_));
+        } catch (...) {
+            // 归还失败时直接释放上下文
+        }
+    }
+    
+    CachedContext(const CachedContext&) = delete;
+    CachedContext& operator=(const CachedContext&) = delete;
+    
+    Context* operator->() { return &ctx_; }
+    
+private:
+    ContextCache<Context>& cache_;
+    Key key_;
+    Context ctx_;
+};
+
+static ContextCache<Zip::Compressor>& compressorCache() {
+    thread_local ContextCache<Zip::Compressor> cache;
+    return cache;
+}
+
+static ContextCache<Zip::Decompressor>& decompressorCache() {
+    thread_local ContextCache<Zip::Decompressor> cache;
+    return cache;
+}
+
+// 从当前线程的缓存借出压缩上下文
+static CachedContext<Zip::Compressor> cachedCompressor(int level, int windowBits = MAX_WBITS,
+                                                       int memLevel = 8,
+                                                       int strategy = Z_DEFAULT_STRATEGY) {
+    Zip::Allocator* allocator = Zip::defaultAllocator();
+    ContextCache<Zip::Compressor>::Key key{level, windowBits, memLevel, strategy, allocator};
+    auto& cache = compressorCache();
+    return CachedContext<Zip::Compressor>(cache, key, cache.take(key, [&] {
+        return Zip::Compressor(level, windowBits, memLevel, strategy, allocator);
+    }));
+}
+
+// 从当前线程的缓存借出解压上下文
+static CachedContext<Zip::Decompressor> cachedDecompressor(int windowBits = MAX_WBITS) {
+    Zip::Allocator* allocator = Zip::defaultAllocator();
+    ContextCache<Zip::Decompressor>::Key key{windowBits, 0, 0, 0, allocator};
+    auto& cache = decompressorCache();
+    return CachedContext<Zip::Decompressor>(cache, key, cache.take(key, [&] {
+        return Zip::Decompressor(windowBits, allocator);
+    }));
+}
+
+void Zip::setContextCacheLimit(size_t maxContexts) {
+    contextCacheMax.store(maxContexts, std::memory_order_relaxed);
+    trimContextCache(maxContexts);
+}
+
+size_t Zip::contextCacheLimit() {
+    return contextCacheMax.load(std::memory_order_relaxed);
+}
+
+void Zip::trimContextCache(size_t keep) {
+    compressorCache().trim(keep);
+    decompressorCache().trim(keep);
+}
+
+// === 静态接口 ===
+
+// 压缩后的最大可能大小
+size_t Zip::compressBound(size_t sourceSize) {
+    if (sourceSize <= std::numeric_limits<uLong>::max() / 2) {
+        return ::compressBound(static_cast<uLong>(sourceSize));
+    }
+    // uLong为32位的平台上按zlib的公式自行计算
+    return sourceSize + (sourceSize >> 12) + (sourceSize >> 14) + (sourceSize >> 25) + 13;
+}
+
+// 压缩实现
+std::vector<uint8_t> Zip::compress(const std::vector<uint8_t>& data, int level) {
+    if (data.empty()) return {};
+    return cachedCompressor(level)->compress(data);
+}
+
+// 压缩到调用方缓冲区
+size_t Zip::compress(const uint8_t* data, size_t size, uint8_t* output,
+                     size_t outputCapacity, int level) {
+    if (size == 0) return 0;
+    return cachedCompressor(level)->compress(data, size, output, outputCapacity);
+}
+
+// 解压实现
+std::vector<uint8_t> Zip::decompress(const std::vector<uint8_t>& compressed) {
+    if (compressed.empty()) return {};
+    return cachedDecompressor()->decompress(compressed);
+}
+
+// 解压实现 (带大小提示与输出上限)
+std::vector<uint8_t> Zip::decompress(const std::vector<uint8_t>& compressed,
+                                     size_t expectedSize, size_t maxOutputSize) {
+    if (compressed.empty()) return {};
+    return cachedDecompressor()->decompress(compressed, expectedSize, maxOutputSize);
+}
+
+// 解压到调用方缓冲区
+size_t Zip::decompress(const uint8_t* compressed, size_t size, uint8_t* output,
+                       size_t outputCapacity) {
+    if (size == 0) return 0;
+    return cachedDecompressor()->decompress(compressed, size, output, outputCapacity);
+}
+
+// === 并行压缩 ===
+
+// deflate的最大回溯距离, 也是分块压缩时预置字典的长度
+static constexpr size_t DICT_SIZE = 32 * 1024;
+
+// 0表示使用硬件线程数
+static unsigned resolveThreads(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max(threads, 1u);
+}
+
+// 启动threads个工作线程执行work(worker), 等待全部结束后重新抛出第一个异常
+static void runWorkers(unsigned threads, const std::function<void(unsigned)>& work) {
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    
+    auto guarded = [&](unsigned worker) {
+        try {
+            work(worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    try {
+        for (unsigned i = 1; i < threads; ++i) workers.emplace_back(guarded, i);
+    } catch (...) {
+        for (auto& t : workers) t.join();
+        throw;
+    }
+    guarded(0);
+    for (auto& t : workers) t.join();
+    
+    if (error) std::rethrow_exception(error);
+}
+
+// 以前一块末尾的数据为字典压缩一块原始deflate数据 (无zlib头尾);
+// 非末块以Z_SYNC_FLUSH按字节对齐结束, 末块以Z_FINISH结束, 各块可按顺序直接拼接
+static void deflateBlock(z_stream& stream, const uint8_t* dict, size_t dictSize,
+                         const uint8_t* data, size_t size, bool last, std::vector<uint8_t>& out) {
+    deflateReset(&stream);
+    if (dictSize > 0) {
+        deflateSetDictionary(&stream, dict, static_cast<uInt>(dictSize));
+    }
+    
+    // deflateBound之外为同步刷新标记留出余量
+    out.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    
+    size_t produced = 0;
+    for (;;) {
+        stream.next_out = out.data() + produced;
+        stream.avail_out = static_cast<uInt>(out.size() - produced);
+        int ret = deflate(&stream, flush);
+        if (ret == Z_STREAM_ERROR) {
+            throw std::runtime_error("Compression failed: " + std::string(zError(ret)));
+        }
+        produced = out.size() - stream.avail_out;
+        
+        bool done = last ? ret == Z_STREAM_END : stream.avail_out != 0;
+        if (done) break;
+        out.resize(out.size() * 2);
+    }
+    out.resize(produced);
+}
+
+// 与deflate输出相同的zlib头 (CMF/FLG, 不含预设字典)
+static void appendZlibHeader(std::vector<uint8_t>& out, int level) {
+    unsigned levelFlags = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned header = (0x78u << 8) | (levelFlags << 6);
+    header += 31 - header % 31;
+    out.push_back(static_cast<uint8_t>(header >> 8));
+    out.push_back(static_cast<uint8_t>(header & 0xFF));
+}
+
+// zlib尾部的Adler-32 (大端序)
+static void appendAdler32(std::vector<uint8_t>& out, uLong adler) {
+    out.push_back(static_cast<uint8_t>(adler >> 24));
+    out.push_back(static_cast<uint8_t>(adler >> 16));
+    out.push_back(static_cast<uint8_t>(adler >> 8));
+    out.push_back(static_cast<uint8_t>(adler));
+}
+
+// 多线程分块压缩
+std::vector<uint8_t> Zip::compressParallel(const std::vector<uint8_t>& data, int level,
+                                           unsigned threads, size_t blockSize) {
+    if (data.empty()) return {};
+    
+    checkLevel(level);
+    blockSize = std::min(std::max(blockSize, DICT_SIZE), MAX_CHUNK);
+    size_t blockCount = (data.size() + blockSize - 1) / blockSize;
+    threads = static_cast<unsigned>(std::min<size_t>(resolveThreads(threads), blockCount));
+    
+    // 只有一块或单线程时与普通压缩结果一致
+    if (threads <= 1) return compress(data, level);
+    
+    std::vector<std::vector<uint8_t>> blocks(blockCount);
+    std::vector<uLong> checksums(blockCount);
+    std::atomic<size_t> next{0};
+    
+    runWorkers(threads, [&](unsigned) {
+        DeflateState deflater(level, -MAX_WBITS);
+        for (size_t i = next++; i < blockCount; i = next++) {
+            size_t start = i * blockSize;
+            size_t size = std::min(blockSize, data.size() - start);
+            size_t dictSize = std::min(start, DICT_SIZE);
+            
+            deflateBlock(deflater.get(), data.data() + start - dictSize, dictSize,
+                         data.data() + start, size, i + 1 == blockCount, blocks[i]);
+            checksums[i] = adler32(1L, data.data() + start, static_cast<uInt>(size));
+        }
+    });
+    
+    // 拼接为单个zlib流, 尾部校验和由各块的Adler-32合并得到
+    size_t total = 6;
+    for (auto& block : blocks) total += block.size();
+    std::vector<uint8_t> result;
+    result.reserve(total);
+    
+    appendZlibHeader(result, level);
+    uLong adler = checksums[0];
+    for (size_t i = 0; i < blockCount; ++i) {
+        result.insert(result.end(), blocks[i].begin(), blocks[i].end());
+        if (i > 0) {
+            size_t size = std::min(blockSize, data.size() - i * blockSize);
+            adler = adler32_combine(adler, checksums[i], static_cast<z_off_t>(size));
+        }
+    }
+    appendAdler32(result, adler);
+    return result;
+}
+
+// 压缩字符串
+std::vector<uint8_t> Zip::compressString(const std::string& str, int level) {
+    std::vector<uint8_t> data(str.begin(), str.end());
+    return compress(data, level);
+}
+
+// 解压字符串
+std::string Zip::decompressString(const std::vector<uint8_t>& compressed) {
+    auto decompressed = decompress(compressed);
+    return std::string(reinterpret_cast<char*>(decompressed.data()), decompressed.size());
+}
+
+// 流水线式并行压缩: 调用线程按顺序读入定长块并写出结果, 工作线程以前一块末尾32KB为字典并行压缩;
+// 在途块数限制为线程数的2倍, 内存占用约为 4 * threads * blockSize, 与输入总量无关
+class ParallelDeflater {
+public:
+    ParallelDeflater(int level, unsigned threads, size_t blockSize, std::ostream& output)
+        : level_(level), blockSize_(blockSize), maxInFlight_(threads * 2), output_(output) {
+        workers_.reserve(threads);
+        try {
+            for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this] { work(); });
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+    
+    ~ParallelDeflater() { stop(); }
+    
+    ParallelDeflater(const ParallelDeflater&) = delete;
+    ParallelDeflater& operator=(const ParallelDeflater&) = delete;
+    
+    // 持续调用read(buffer, size)读取输入直到返回不足size (输入结束), 写出完整的zlib流
+    template <typename Read>
+    void run(Read&& read) {
+        std::vector<uint8_t> header;
+        appendZlibHeader(header, level_);
+        output_.write(reinterpret_cast<const char*>(header.data()), header.size());
+        
+        std::vector<uint8_t> tail;  // 前一块末尾的数据, 作为下一块的字典
+        for (;;) {
+            std::unique_ptr<Job> job = acquireJob();
+            job->dictSize = tail.size();
+            job->input.resize(tail.size() + blockSize_);
+            std::copy(tail.begin(), tail.end(), job->input.begin());
+            job->size = read(job->input.data() + job->dictSize, blockSize_);
+            
+            if (job->size == 0) {
+                freeJobs_.push_back(std::move(job));
+                break;
+            }
+            
+            size_t end = job->dictSize + job->size;
+            size_t keep = std::min(end, DICT_SIZE);
+            tail.assign(job->input.begin() + (end - keep), job->input.begin() + end);
+            
+            bool last = job->size < blockSize_;
+            submit(std::move(job));
+            if (last) break;
+        }
+        
+        while (!inFlight_.empty()) writeNext();
+        
+        // 末尾追加空的最终块 (BFINAL=1的固定Huffman块, 仅含块结束符) 与合并后的校验和
+        std::vector<uint8_t> trailer = {0x03, 0x00};
+        appendAdler32(trailer, adler_);
+        output_.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+    }
+    
+private:
+    struct Job {
+        std::vector<uint8_t> input;   // [字典][数据]
+        size_t dictSize = 0;
+        size_t size = 0;
+        std::vector<uint8_t> output;
+        uLong adler = 1;
+        bool done = false;
+    };
+    
+    void work() {
+        std::unique_ptr<DeflateState> deflater;
+        for (;;) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                workReady_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+                if (stopping_) return;
+                job = pending_.front();
+                pending_.pop_front();
+            }
+            
+            try {
+                if (!deflater) deflater.reset(new DeflateState(level_, -MAX_WBITS));
+                const uint8_t* data = job->input.data() + job->dictSize;
+                deflateBlock(deflater->get(), job->input.data(), job->dictSize,
+                             data, job->size, false, job->output);
+                job->adler = adler32(1L, data, static_cast<uInt>(job->size));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->done = true;
+            jobDone_.notify_all();
+        }
+    }
+    
+    // 取得空闲块; 在途块数已满时先写出最早的块
+    std::unique_ptr<Job> acquireJob() {
+        while (inFlight_.size() >= maxInFlight_) writeNext();
+        if (freeJobs_.empty()) return std::unique_ptr<Job>(new Job);
+        std::unique_ptr<Job> job = std::move(freeJobs_.back());
+        freeJobs_.pop_back();
+        return job;
+    }
+    
+    void submit(std::unique_ptr<Job> job) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->done = false;
+        pending_.push_back(job.get());
+        inFlight_.push_back(std::move(job));
+        workReady_.notify_one();
+    }
+    
+    // 等待最早提交的块完成, 按顺序写出并回收
+    void writeNext() {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            Job* head = inFlight_.front().get();
+            jobDone_.wait(lock, [&] { return head->done || error_; });
+            if (error_) std::rethrow_exception(error_);
+            job = std::move(inFlight_.front());
+            inFlight_.pop_front();
+        }
+        
+        output_.write(reinterpret_cast<const char*>(job->output.data()), job->output.size());
+        adler_ = adler32_combine(adler_, job->adler, static_cast<z_off_t>(job->size));
+        freeJobs_.push_back(std::move(job));
+    }
+    
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        workReady_.notify_all();
+        for (auto& t : workers_) t.join();
+        workers_.clear();
+    }
+    
+    int level_;
+    size_t blockSize_;
+    size_t maxInFlight_;
+    std::ostream& output_;
+    uLong adler_ = 1;
+    
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable workReady_;
+    std::condition_variable jobDone_;
+    std::deque<Job*> pending_;
+    std::deque<std::unique_ptr<Job>> inFlight_;
+    std::vector<std::unique_ptr<Job>> freeJobs_;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+};
+
+// === 并行解压 (串接的成员) ===
+
+// 每个线程每轮至少分到的压缩数据量
+static constexpr size_t MEMBER_SEGMENT_MIN = 64 * 1024;
+
+// 尚未确认任何数据时假定的压缩率, 用于按暂存上限估算每个线程分到的压缩数据量
+static constexpr size_t MEMBER_RATIO_GUESS = 4;
+
+// inflateMember的结果: 输出超过上限, 已中止
+static constexpr int MEMBER_OVER_LIMIT = -100;
+
+// 可能的zlib成员头: CM为deflate、窗口不超过32KB、校验位正确且不使用预设字典
+static bool isMemberHeader(const uint8_t* p) {
+    return (p[0] & 0x0f) == Z_DEFLATED && (p[0] >> 4) <= 7 &&
+           ((p[0] << 8) | p[1]) % 31 == 0 && !(p[1] & 0x20);
+}
+
+// 内存中的整块输入, 按偏移访问
+class MemoryView {
+public:
+    explicit MemoryView(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+    
+    // offset处起连续可读的数据及其长度
+    const uint8_t* at(size_t offset, size_t& length) const {
+        length = size_ - offset;
+        return data_ + offset;
+    }
+    
+private:
+    const uint8_t* data_;
+    size_t size_;
+};
+
+// 从view的offset处解压一个完整成员 (输入共size字节), 输出经outBuf交给sink; consumed为成员占用的字节数.
+// 返回zlib结果码: Z_STREAM_END表示成功, Z_BUF_ERROR表示输入不完整, 输出超过limit时返回MEMBER_OVER_LIMIT
+template <typename View, typename Sink>
+static int inflateMember(z_stream& stream, View& view, size_t offset, size_t size,
+                         uint8_t* outBuf, size_t outSize, size_t limit, Sink&& sink, size_t& consumed) {
+    inflateReset(&stream);
+    consumed = 0;
+    size_t produced = 0;
+    int ret;
+    do {
+        size_t available;
+        const uint8_t* data = view.at(offset + consumed, available);
+        size_t chunk = std::min(available, MAX_CHUNK);
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = static_cast<uInt>(chunk);
+        do {
+            stream.next_out = outBuf;
+            stream.avail_out = static_cast<uInt>(outSize);
+            ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) return ret;
+            size_t have = outSize - stream.avail_out;
+            produced += have;
+            if (produced > limit) return MEMBER_OVER_LIMIT;
+            if (have > 0) sink(outBuf, have);
+        } while (ret != Z_STREAM_END && stream.avail_out == 0);
+        consumed += chunk - stream.avail_in;
+    } while (ret != Z_STREAM_END && offset + consumed < size);
+    return ret == Z_STREAM_END ? ret : Z_BUF_ERROR;
+}
+
+// 串接成员的并行解压. 线程0从已确认的成员起点按顺序解压, 输出直接交给sink; 第一个成员结束后仍有输入时
+// 才开始推测: 每轮把输入按区间分给各线程, 其他线程在各自区间内找到第一个能完整解出 (含校验和) 的成员,
+// 从它起解压所有在区间内开始的成员并暂存输出, 每个线程暂存不超过limit (超出的成员丢弃).
+// 起点恰好衔接在已确认部分之后的线程按顺序写出, 无法衔接时下一轮由线程0从已确认处继续.
+// makeView()为每个线程创建按偏移访问输入的视图; 区间不超过segment, 并按已确认部分的压缩率缩小.
+// outSize为线程0的解压缓冲区大小
+template <typename MakeView, typename Sink>
+static void inflateMembersParallel(size_t size, MakeView&& makeView, unsigned threads, size_t segment,
+                                   size_t limit, size_t outSize, Sink&& sink) {
+    constexpr size_t NONE = SIZE_MAX;
+    threads = std::max(threads, 1u);
+    std::vector<std::vector<uint8_t>> outputs(threads);
+    std::vector<size_t> begins(threads), ends(threads);
+    uint64_t totalIn = 0;
+    uint64_t totalOut = 0;
+    bool speculate = false;
+    
+    for (size_t start = 0; start < size;) {
+        uint64_t ratio = totalIn > 0 ? std::max<uint64_t>((totalOut + totalIn - 1) / totalIn, 1)
+                                     : MEMBER_RATIO_GUESS;
+        size_t span = std::max(static_cast<size_t>(std::min<uint64_t>(segment, limit / ratio)), MEMBER_SEGMENT_MIN);
+        unsigned active = speculate
+            ? static_cast<unsigned>(std::min<size_t>(threads, (size - start + span - 1) / span))
+            : 1;
+        uint64_t written = 0;
+        
+        runWorkers(active, [&](unsigned worker) {
+            std::vector<uint8_t>& output = outputs[worker];
+            output.clear();
+            begins[worker] = ends[worker] = NONE;
+            size_t lo = start + worker * span;
+            size_t hi = lo + std::min(size - lo, span);
+            
+            // 推测线程的输出暂存在output中, 只需较小的解压缓冲区
+            size_t bufferSize = worker == 0 ? outSize : std::min(outSize, STREAM_CHUNK_SIZE);
+            auto view = makeView();
+            InflateState inflater(MAX_WBITS);
+            PooledBuffer out(bufferSize);
+            size_t pos = lo;
+            size_t used = 0;
+            
+            // 未开始推测时只解一个成员, 单个成员的输入不做无用的推测
+            if (worker == 0) {
+                if (!speculate) hi = lo + 1;
+                auto write = [&](const uint8_t* p, size_t n) {
+                    written += n;
+                    sink(p, n);
+                };
+                do {
+                    int ret = inflateMember(inflater.get(), view, pos, size, out.data(), bufferSize, SIZE_MAX,
+                                            write, used);
+                    if (ret == Z_BUF_ERROR) throw std::runtime_error("Decompression incomplete");
+                    if (ret != Z_STREAM_END) {
+                        throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+                    }
+                    pos += used;
+                } while (pos < hi);
+                begins[0] = lo;
+                ends[0] = pos;
+                return;
+            }
+            
+            if (limit != SIZE_MAX) output.reserve(limit);
+            auto keep = [&output](const uint8_t* p, size_t n) { output.insert(output.end(), p, p + n); };
+            
+            // 伪成员头几乎总会在解出少量数据后出错, 校验和保证找到的是真实成员;
+            // 超过暂存上限的成员留给线程0流式解压
+            bool found = false;
+            while (!found && pos < hi && size - pos >= 2) {
+                size_t length;
+                int ret = isMemberHeader(view.at(pos, length))
+                    ? inflateMember(inflater.get(), view, pos, size, out.data(), bufferSize, limit, keep, used)
+                    : Z_DATA_ERROR;
+                if (ret == Z_STREAM_END) {
+                    found = true;
+                } else {
+                    output.clear();
+                    if (ret == MEMBER_OVER_LIMIT) return;
+                    ++pos;
+                }
+            }
+            if (!found) return;
+            begins[worker] = pos;
+            pos += used;
+            
+            // 解不出或超过暂存上限的成员留给下一轮的线程0
+            while (pos < hi) {
+                size_t mark = output.size();
+                int ret = inflateMember(inflater.get(), view, pos, size, out.data(), bufferSize, limit - mark,
+                                        keep, used);
+                if (ret != Z_STREAM_END) {
+                    output.resize(mark);
+                    break;
+                }
+                pos += used;
+            }
+            ends[worker] = pos;
+        });
+        
+        // 区间落在已解出的成员内部 (未找到或起点更早) 的线程跳过, 出现空隙时停止
+        size_t end = ends[0];
+        for (unsigned worker = 1; worker < active; ++worker) {
+            if (begins[worker] == NONE || begins[worker] < end) continue;
+            if (begins[worker] > end) break;
+            sink(outputs[worker].data(), outputs[worker].size());
+            written += outputs[worker].size();
+            end = ends[worker];
+        }
+        totalIn += end - start;
+        totalOut += written;
+        start = end;
+        speculate = true;
+    }
+}
+
+// 并行解压串接的成员
+std::vector<uint8_t> Zip::decompressParallel(const std::vector<uint8_t>& compressed, unsigned threads) {
+    if (compressed.empty()) return {};
+    
+    threads = resolveThreads(threads);
+    size_t segment = std::max((compressed.size() + threads - 1) / threads, MEMBER_SEGMENT_MIN);
+    if (threads == 1 || segment >= compressed.size()) return decompress(compressed);
+    
+    std::vector<uint8_t> result;
+    inflateMembersParallel(compressed.size(), [&] { return MemoryView(compressed.data(), compressed.size()); },
+                           threads, segment, SIZE_MAX, 2 * STREAM_CHUNK_SIZE,
+                           [&result](const uint8_t* data, size_t size) {
+                               result.insert(result.end(), data, data + size);
+                           });
+    return result;
+}
+
+// === 流水线压缩 ===
+
+// 无界阻塞队列; 各阶段间的内存由循环使用的固定数量缓冲区限定. close()后pop在取空时返回false
+template <typename T>
+class BlockingQueue {
+public:
+    void push(T value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.push_back(std::move(value));
+        ready_.notify_one();
+    }
+    
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+    
+    // 最多等待到deadline; 超时返回false且timedOut为true
+    bool pop(T& value, std::chrono::steady_clock::time_point deadline, bool& timedOut) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        timedOut = !ready_.wait_until(lock, deadline, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+    
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        ready_.notify_all();
+    }
+    
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
+
+// 后台读取线程: 循环使用depth个输入缓冲区, read(buffer, size)返回读入的字节数.
+// shortReadEnds为true时不足size即视为输入结束, 否则只有返回0才结束.
+// 读取线程共享持有队列与read的副本, 出错时abandon()不必等待阻塞在读取中的线程; 放弃后不再开始新的读取
+template <typename Read>
+class InputReader {
+public:
+    using Buffer = std::vector<uint8_t>;
+    
+    InputReader(Read read, size_t bufferSize, size_t depth, bool shortReadEnds)
+        : state_(std::make_shared<State>(std::move(read))), bufferSize_(bufferSize) {
+        for (size_t i = 0; i < depth; ++i) state_->freeIn.push(Buffer(bufferSize));
+        std::shared_ptr<State> state = state_;
+        thread_ = std::thread([state, bufferSize, shortReadEnds] {
+            try {
+                Buffer buffer;
+                while (state->freeIn.pop(buffer)) {
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if (state->abandoned) break;
+                        state->reading = true;
+                    }
+                    buffer.resize(state->read(buffer.data(), bufferSize));
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->reading = false;
+                    }
+                    bool eof = shortReadEnds ? buffer.size() < bufferSize : buffer.empty();
+                    if (!buffer.empty()) state->fullIn.push(std::move(buffer));
+                    if (eof) break;
+                }
+            } catch (...) {
+                state->error = std::current_exception();
+            }
+            state->fullIn.close();
+            state->done = true;
+        });
+    }
+    
+    ~InputReader() {
+        if (thread_.joinable()) abandon();
+    }
+    
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+    
+    // 取下一个已读入的缓冲区; 输入结束 (或读取出错) 时返回false
+    bool pop(Buffer& buffer) { return state_->fullIn.pop(buffer); }
+    bool pop(Buffer& buffer, std::chrono::steady_clock::time_point deadline, bool& timedOut) {
+        return state_->fullIn.pop(buffer, deadline, timedOut);
+    }
+    
+    // 归还用完的缓冲区
+    void recycle(Buffer buffer) {
+        buffer.resize(bufferSize_);
+        state_->freeIn.push(std::move(buffer));
+    }
+    
+    // 正常结束: 等待读取线程退出并转发读取错误
+    void finish() {
+        state_->freeIn.close();
+        thread_.join();
+        if (state_->error) std::rethrow_exception(state_->error);
+    }
+    
+    // 出错时放弃: 读取线程正阻塞在读取中则分离它 (完成这次读取后自行退出, 不再读取),
+    // 否则等待它退出并返回其错误
+    std::exception_ptr abandon() {
+        bool reading;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->abandoned = true;
+            reading = state_->reading;
+        }
+        state_->freeIn.close();
+        if (reading && !state_->done) {
+            thread_.detach();
+            return nullptr;
+        }
+        thread_.join();
+        return state_->error;
+    }
+    
+private:
+    struct State {
+        explicit State(Read value) : read(std::move(value)) {}
+        Read read;
+        BlockingQueue<Buffer> freeIn, fullIn;
+        std::exception_ptr error;
+        std::atomic<bool> done{false};
+        std::mutex mutex;
+        bool abandoned = false;     // 以下两项受mutex保护
+        bool reading = false;
+    };
+    
+    std::shared_ptr<State> state_;
+    size_t bufferSize_;
+    std::thread thread_;
+};
+
+// 三段流水线压缩: 读取线程填充输入缓冲区, 调用线程执行deflate, 写入线程写出已满的输出缓冲区;
+// 输入/输出各depth个缓冲区循环使用. read(buffer, size)除输入结束外须填满size字节, 它被复制到
+// 读取线程中, 出错时可能在本函数返回后完成最后一次调用 (不能引用调用方的局部变量);
+// skipEmpty为true时空输入不产生任何输出
+template <typename Read, typename Write>
+static void deflatePipelined(z_stream& stream, Read read, Write&& write,
+                             size_t inSize, size_t outSize, size_t depth, bool skipEmpty) {
+    using Buffer = std::vector<uint8_t>;
+    BlockingQueue<Buffer> freeOut, fullOut;
+    for (size_t i = 0; i < depth; ++i) freeOut.push(Buffer(outSize));
+    
+    InputReader<Read> reader(std::move(read), inSize, depth, true);
+    
+    std::exception_ptr writeError;
+    std::thread writer([&] {
+        try {
+            Buffer buffer;
+            while (fullOut.pop(buffer)) {
+                write(buffer.data(), buffer.size());
+                buffer.resize(outSize);
+                freeOut.push(std::move(buffer));
+            }
+        } catch (...) {
+            writeError = std::current_exception();
+            freeOut.close();
+        }
+    });
+    
+    auto stopWriter = [&] {
+        fullOut.close();
+        writer.join();
+    };
+    
+    try {
+        Buffer out;
+        auto nextOut = [&] {
+            if (!freeOut.pop(out)) throw std::runtime_error("Pipeline writer stopped");
+            stream.next_out = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+        };
+        nextOut();
+        
+        bool first = true;
+        int flush;
+        do {
+            Buffer in;
+            bool got = reader.pop(in);
+            if (!got && first && skipEmpty) {
+                stopWriter();
+                reader.finish();
+                return;
+            }
+            first = false;
+            
+            flush = got ? Z_NO_FLUSH : Z_FINISH;
+            stream.next_in = in.data();
+            stream.avail_in = static_cast<uInt>(in.size());
+            
+            // 输出缓冲区写满才交给写入线程, 写出总是整块
+            for (;;) {
+                int err = deflate(&stream, flush);
+                if (err == Z_STREAM_ERROR) {
+                    throw std::runtime_error("Compression error: " + std::string(zError(err)));
+                }
+                if (stream.avail_out != 0) break;
+                fullOut.push(std::move(out));
+                nextOut();
+            }
+            
+            if (got) reader.recycle(std::move(in));
+        } while (flush != Z_FINISH);
+        
+        out.resize(out.size() - stream.avail_out);
+        if (!out.empty()) fullOut.push(std::move(out));
+    } catch (...) {
+        // 不等待可能阻塞在输入上的读取线程, 以免下游出错时卡在空闲的输入上
+        std::exception_ptr readError = reader.abandon();
+        stopWriter();
+        if (readError) std::rethrow_exception(readError);
+        if (writeError) std::rethrow_exception(writeError);
+        throw;
+    }
+    
+    stopWriter();
+    reader.finish();
+    if (writeError) std::rethrow_exception(writeError);
+}
+
+// 流水线模式下每侧循环使用的缓冲区数量
+static constexpr size_t PIPELINE_DEPTH = 4;
+
+// 读取已到达的数据: 阻塞到至少有1字节可读, 然后只取流缓冲区报告可用的部分; 返回0表示输入结束
+static size_t readAvailable(std::istream& input, uint8_t* buffer, size_t size) {
+    std::streambuf* source = input.rdbuf();
+    using Traits = std::char_traits<char>;
+    if (!source || Traits::eq_int_type(source->sgetc(), Traits::eof())) {
+        input.setstate(std::ios::eofbit);
+        return 0;
+    }
+    std::streamsize available = std::max<std::streamsize>(source->in_avail(), 1);
+    available = std::min(available, static_cast<std::streamsize>(size));
+    return static_cast<size_t>(source->sgetn(reinterpret_cast<char*>(buffer), available));
+}
+
+// 低延迟流式压缩: 读取线程把已到达的数据交给调用线程压缩; 满足刷新条件或输入空闲到期时
+// 以策略的模式刷新, 写出并flush输出流. 输入缓冲区循环使用, 内存有上限.
+// 出错时不等待读取线程: 它可能仍阻塞在input上, 完成当前这次读取后退出
+static void deflateAutoFlush(z_stream& stream, std::istream& input, std::ostream& output,
+                             const Zip::FlushPolicy& policy, size_t inSize, size_t outSize) {
+    using Buffer = std::vector<uint8_t>;
+    auto read = [&input](uint8_t* buffer, size_t size) { return readAvailable(input, buffer, size); };
+    InputReader<decltype(read)> reader(read, inSize, PIPELINE_DEPTH, false);
+    
+    try {
+        PooledBuffer out(outSize);
+        FlushClock clock(policy);
+        
+        // 压缩当前输入, 输出缓冲区满即写出; flush不为Z_NO_FLUSH时写出全部结果并刷新输出流
+        auto run = [&](int flush) {
+            for (;;) {
+                stream.next_out = out.data();
+                stream.avail_out = static_cast<uInt>(outSize);
+                int err = deflate(&stream, flush);
+                if (err == Z_STREAM_ERROR) {
+                    throw std::runtime_error("Compression error: " + std::string(zError(err)));
+                }
+                size_t have = outSize - stream.avail_out;
+                if (have > 0 && !output.write(reinterpret_cast<const char*>(out.data()),
+                                              static_cast<std::streamsize>(have))) {
+                    throw std::runtime_error("Failed to write output stream");
+                }
+                if (stream.avail_out != 0) break;
+            }
+            if (flush != Z_NO_FLUSH) {
+                if (!output.flush()) throw std::runtime_error("Failed to write output stream");
+                clock.reset();
+            }
+        };
+        
+        for (;;) {
+            Buffer in;
+            bool timedOut = false;
+            bool got = clock.pending() && clock.timed()
+                ? reader.pop(in, clock.deadline(), timedOut)
+                : reader.pop(in);
+            if (timedOut) {
+                stream.avail_in = 0;
+                run(clock.flush());
+                continue;
+            }
+            if (!got) break;
+            
+            stream.next_in = in.data();
+            stream.avail_in = static_cast<uInt>(in.size());
+            clock.add(in.size());
+            run(clock.due() ? clock.flush() : Z_NO_FLUSH);
+            reader.recycle(std::move(in));
+        }
+        
+        stream.next_in = nullptr;
+        stream.avail_in = 0;
+        run(Z_FINISH);
+    } catch (...) {
+        // 输出出错时输入可能正空闲, 不等待阻塞在读取中的线程
+        std::exception_ptr readError = reader.abandon();
+        if (readError) std::rethrow_exception(readError);
+        throw;
+    }
+    
+    reader.finish();
+}
+
+// === 文件输入 ===
+
+#ifdef ZIP_HAVE_MMAP
+// 关闭文件描述符的守卫
+struct FdGuard {
+    int fd;
+    explicit FdGuard(int value) : fd(value) {}
+    ~FdGuard() { if (fd >= 0) ::close(fd); }
+    FdGuard(const FdGuard&) = delete;
+    FdGuard& operator=(const FdGuard&) = delete;
+};
+
+
+// 文件描述符I/O的缓冲区大小 (页对齐)
+static constexpr size_t FD_BUFFER_SIZE = 256 * 1024;
+
+// 对齐缓冲区的对齐粒度, 同时满足直接I/O对缓冲区地址、长度与文件偏移的对齐要求
+static constexpr size_t FD_BUFFER_ALIGN = 4096;
+
+// 页对齐缓冲区
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t size)
+        : size_(size) {
+        void* data = nullptr;
+        if (::posix_memalign(&data, FD_BUFFER_ALIGN, size) != 0) throw std::bad_alloc();
+        data_ = static_cast<uint8_t*>(data);
+    }
+    
+    ~AlignedBuffer() { std::free(data_); }
+    
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    
+    uint8_t* data() { return data_; }
+    size_t size() const { return size_; }
+    
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_;
+};
+
+// 以直接I/O (绕过页缓存) 打开文件; 文件系统不支持时退回普通打开
+static int openDirect(const std::string& path, int flags, mode_t mode) {
+#ifdef O_DIRECT
+    int fd = ::open(path.c_str(), flags | O_DIRECT, mode);
+    if (fd >= 0 || errno != EINVAL) return fd;
+    return ::open(path.c_str(), flags, mode);
+#else
+    int fd = ::open(path.c_str(), flags, mode);
+#ifdef F_NOCACHE
+    if (fd >= 0) ::fcntl(fd, F_NOCACHE, 1);
+#endif
+    return fd;
+#endif
+}
+
+// 写入文件描述符的输出缓冲区基类: 缓冲区写满时交给flushFull(), finish()写出剩余数据;
+// 写入错误记录在error_中, 由write()/finish()抛出
+class FdOutputBuf : public std::streambuf {
+public:
+    FdOutputBuf(int fd, size_t bufferSize)
+        : fd_(fd), buffer_(std::max(bufferSize / FD_BUFFER_ALIGN, size_t(1)) * FD_BUFFER_ALIGN) {
+        reset();
+    }
+    
+    // 写入数据, 失败时抛出
+    void write(const uint8_t* data, size_t size) {
+        sputn(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        checkError();
+    }
+    
+    // 写出缓冲区中剩余的数据, 失败时抛出
+    virtual void finish() = 0;
+    
+protected:
+    int_type overflow(int_type ch) override {
+        if (error_ != 0 || !flushFull()) return traits_type::eof();
+        reset();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    
+    virtual bool flushFull() = 0;
+    
+    size_t pending() const { return static_cast<size_t>(pptr() - pbase()); }
+    
+    // offset < 0 时顺序写, 否则写到指定偏移
+    bool writeAll(const uint8_t* data, size_t size, off_t offset = -1) {
+        while (size > 0) {
+            ssize_t n = offset < 0 ? ::write(fd_, data, size) : ::pwrite(fd_, data, size, offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                error_ = n < 0 ? errno : EIO;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            if (offset >= 0) offset += n;
+        }
+        return true;
+    }
+    
+    // 临时取消O_DIRECT以写出不足一块的尾部, 返回原标志 (无需恢复时为-1)
+    int dropDirect() {
+#ifdef O_DIRECT
+        int flags = ::fcntl(fd_, F_GETFL);
+        if (flags >= 0 && (flags & O_DIRECT)) {
+            ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+            return flags;
+        }
+#endif
+        return -1;
+    }
+    
+    void restoreFlags(int flags) {
+        if (flags >= 0) ::fcntl(fd_, F_SETFL, flags);
+    }
+    
+    void reset() {
+        char* base = reinterpret_cast<char*>(buffer_.data());
+        setp(base, base + buffer_.size());
+    }
+    
+    void checkError() {
+        if (error_ != 0) throw std::runtime_error("Failed to write output: " + std::string(std::strerror(error_)));
+    }
+    
+    int fd_;
+    AlignedBuffer buffer_;
+    int error_ = 0;
+};
+
+// 直接I/O输出缓冲区: 平时只以对齐的整块写出, finish()时临时取消O_DIRECT写出不足一块的尾部
+class DirectOutputBuf : public FdOutputBuf {
+public:
+    using FdOutputBuf::FdOutputBuf;
+    
+    void finish() override {
+        size_t length = pending();
+        size_t aligned = length / FD_BUFFER_ALIGN * FD_BUFFER_ALIGN;
+        if (error_ == 0 && writeAll(buffer_.data(), aligned) && length > aligned) {
+            int flags = dropDirect();
+            writeAll(buffer_.data() + aligned, length - aligned);
+            restoreFlags(flags);
+        }
+        reset();
+        checkError();
+    }
+    
+protected:
+    bool flushFull() override { return writeAll(buffer_.data(), buffer_.size()); }
+};
+
+// 检测数据是否全为零: 每次对8个64位字做按位或, 便于编译器向量化
+static bool isAllZero(const uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint64_t words[8];
+        std::memcpy(words, data + i, sizeof(words));
+        uint64_t any = 0;
+        for (uint64_t word : words) any |= word;
+        if (any != 0) return false;
+    }
+    for (; i < size; ++i) {
+        if (data[i] != 0) return false;
+    }
+    return true;
+}
+
+// 稀疏输出缓冲区: 按块检测全零数据, 全零块跳过不写 (在截断后的新文件中即为空洞), 其余相邻块合并写出;
+// finish()时按总长度截断文件, 使末尾的空洞也计入文件大小. 块与文件偏移对齐, 可与直接I/O同时使用
+class SparseOutputBuf : public FdOutputBuf {
+public:
+    using FdOutputBuf::FdOutputBuf;
+    
+    void finish() override {
+        if (error_ == 0) {
+            int flags = dropDirect();
+            writeBlocks(pending());
+            restoreFlags(flags);
+        }
+        reset();
+        if (error_ == 0 && ::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) error_ = errno;
+        checkError();
+    }
+    
+protected:
+    bool flushFull() override { return writeBlocks(buffer_.size()); }
+    
+private:
+    bool writeBlocks(size_t length) {
+        const uint8_t* data = buffer_.data();
+        size_t pos = 0;
+        while (pos < length) {
+            while (pos < length && isAllZero(data + pos, std::min(FD_BUFFER_ALIGN, length - pos))) {
+                pos += std::min(FD_BUFFER_ALIGN, length - pos);
+            }
+            size_t start = pos;
+            while (pos < length && !isAllZero(data + pos, std::min(FD_BUFFER_ALIGN, length - pos))) {
+                pos += std::min(FD_BUFFER_ALIGN, length - pos);
+            }
+            if (pos > start && !writeAll(data + start, pos - start, static_cast<off_t>(offset_ + start))) {
+                return false;
+            }
+        }
+        offset_ += length;
+        return true;
+    }
+    
+    size_t offset_ = 0;
+};
+
+#endif
+
+// 分段读取的输入文件: 普通文件按窗口逐段映射(读完即解除映射), 直接I/O模式下改为对齐缓冲区顺序读取,
+// 管道/设备等或不支持映射的平台退回定长缓冲读取; 各种方式的内存占用都只与窗口大小有关
+class InputFile {
+public:
+    InputFile(const std::string& path, size_t windowSize, bool direct = false)
+        : windowSize_(windowSize) {
+#ifdef ZIP_HAVE_MMAP
+        fd_ = direct ? openDirect(path, O_RDONLY | O_CLOEXEC, 0) : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) throw std::runtime_error("Failed to open input file: " + path);
+        
+        struct stat st;
+        if (direct) {
+            direct_.reset(new AlignedBuffer(std::max(windowSize_ / FD_BUFFER_ALIGN, size_t(1)) * FD_BUFFER_ALIGN));
+            return;
+        }
+        if (::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+            // 映射偏移必须按页对齐
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            windowSize_ = std::max(windowSize_ / page, size_t(1)) * page;
+            fileSize_ = static_cast<size_t>(st.st_size);
+            mapped_ = true;
+            return;
+        }
+        // 管道/设备等直接从已打开的描述符读取, 重新打开会丢失FIFO中已写入的数据
+        buffer_.resize(windowSize_);
+#else
+        (void)direct;  // 不支持直接I/O的平台
+        stream_.open(path, std::ios::binary);
+        if (!stream_) throw std::runtime_error("Failed to open input file: " + path);
+        buffer_.resize(windowSize_);
+#endif
+    }
+    
+    ~InputFile() {
+#ifdef ZIP_HAVE_MMAP
+        unmap();
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+    
+    // 读取到调用方缓冲区, 除非到达文件末尾否则填满size字节
+    size_t read(uint8_t* buffer, size_t size) {
+#ifdef ZIP_HAVE_MMAP
+        size_t total = 0;
+        if (direct_) {
+            while (total < size && (directPos_ < directLength_ || fillDirect())) {
+                size_t n = std::min(size - total, directLength_ - directPos_);
+                std::memcpy(buffer + total, direct_->data() + directPos_, n);
+                directPos_ += n;
+                total += n;
+            }
+            return total;
+        }
+        if (mapped_) {
+            while (total < size && offset_ < fileSize_) {
+                ssize_t n = ::pread(fd_, buffer + total, std::min(size - total, MAX_CHUNK),
+                                    static_cast<off_t>(offset_));
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) throw std::runtime_error("Failed to read input file: " + std::string(std::strerror(errno)));
+                if (n == 0) break;
+                total += static_cast<size_t>(n);
+                offset_ += static_cast<size_t>(n);
+            }
+            return total;
+        }
+        while (total < size) {
+            size_t n = readFd(buffer + total, size - total);
+            if (n == 0) break;
+            total += n;
+        }
+        return total;
+#else
+        stream_.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+        return static_cast<size_t>(stream_.gcount());
+#endif
+    }
+    
+    // 读取下一段, 返回长度0表示文件结束; 上一段数据在本次调用后失效
+    size_t next(const uint8_t*& data) {
+#ifdef ZIP_HAVE_MMAP
+        if (direct_) {
+            if (directPos_ == directLength_ && !fillDirect()) return 0;
+            data = direct_->data() + directPos_;
+            size_t length = directLength_ - directPos_;
+            directPos_ = directLength_;
+            return length;
+        }
+        if (mapped_) {
+            unmap();
+            if (offset_ >= fileSize_) return 0;
+            
+            size_t length = std::min(windowSize_, fileSize_ - offset_);
+            void* window = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd_, static_cast<off_t>(offset_));
+            if (window == MAP_FAILED) throw std::runtime_error("Failed to map input file");
+            ::madvise(window, length, MADV_SEQUENTIAL);
+            
+            window_ = window;
+            windowLength_ = length;
+            offset_ += length;
+            data = static_cast<const uint8_t*>(window);
+            return length;
+        }
+        data = buffer_.data();
+        return readFd(buffer_.data(), buffer_.size());
+#else
+        stream_.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        data = buffer_.data();
+        return static_cast<size_t>(stream_.gcount());
+#endif
+    }
+    
+private:
+#ifdef ZIP_HAVE_MMAP
+    void unmap() {
+        if (window_) ::munmap(window_, windowLength_);
+        window_ = nullptr;
+    }
+    
+    // 从描述符读取一次 (处理EINTR), 返回0表示结束
+    size_t readFd(uint8_t* buffer, size_t size) {
+        for (;;) {
+            ssize_t n = ::read(fd_, buffer, std::min(size, MAX_CHUNK));
+            if (n >= 0) return static_cast<size_t>(n);
+            if (errno != EINTR) {
+                throw std::runtime_error("Failed to read input file: " + std::string(std::strerror(errno)));
+            }
+        }
+    }
+    
+    // 直接I/O: 按整块填满对齐缓冲区 (只有文件末尾不足一块), 保持后续读取的文件偏移对齐
+    bool fillDirect() {
+        size_t total = 0;
+        while (total < direct_->size()) {
+            ssize_t n = ::read(fd_, direct_->data() + total, direct_->size() - total);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::runtime_error("Failed to read input file: " + std::string(std::strerror(errno)));
+            if (n == 0) break;
+            total += static_cast<size_t>(n);
+        }
+        directPos_ = 0;
+        directLength_ = total;
+        return total > 0;
+    }
+    
+    int fd_ = -1;
+    std::unique_ptr<AlignedBuffer> direct_;
+    size_t directPos_ = 0;
+    size_t directLength_ = 0;
+    bool mapped_ = false;
+    size_t fileSize_ = 0;
+    size_t offset_ = 0;
+    void* window_ = nullptr;
+    size_t windowLength_ = 0;
+#endif
+    size_t windowSize_;
+    std::ifstream stream_;
+    std::vector<uint8_t> buffer_;
+};
+
+// 输出文件: 默认使用ofstream; 直接I/O模式下经对齐缓冲区写入, 稀疏模式下全零块写成空洞
+class OutputFile {
+public:
+    OutputFile(const std::string& path, bool direct, bool sparse = false)
+        : path_(path) {
+#ifdef ZIP_HAVE_MMAP
+        if (direct || sparse) {
+            int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+            fd_ = direct ? openDirect(path, flags, 0666) : ::open(path.c_str(), flags, 0666);
+            if (fd_ < 0) throw std::runtime_error("Failed to open output file: " + path);
+            
+            // 空洞只能出现在普通文件中, 其他输出按顺序写出
+            struct stat st;
+            if (sparse && ::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+                buffer_.reset(new SparseOutputBuf(fd_, FD_BUFFER_SIZE));
+            } else {
+                buffer_.reset(new DirectOutputBuf(fd_, FD_BUFFER_SIZE));
+            }
+            bufferStream_.rdbuf(buffer_.get());
+            return;
+        }
+#else
+        (void)direct;
+        (void)sparse;
+#endif
+        file_.open(path, std::ios::binary);
+        if (!file_) throw std::runtime_error("Failed to open output file: " + path);
+    }
+    
+    ~OutputFile() {
+#ifdef ZIP_HAVE_MMAP
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+    
+    std::ostream& stream() {
+#ifdef ZIP_HAVE_MMAP
+        if (buffer_) return bufferStream_;
+#endif
+        return file_;
+    }
+    
+    // 写出全部剩余数据, 失败时抛出
+    void close() {
+        if (!stream().flush()) throw std::runtime_error("Failed to write output file: " + path_);
+#ifdef ZIP_HAVE_MMAP
+        if (buffer_) buffer_->finish();
+#endif
+    }
+    
+private:
+    std::string path_;
+    std::ofstream file_;
+#ifdef ZIP_HAVE_MMAP
+    int fd_ = -1;
+    std::unique_ptr<FdOutputBuf> buffer_;
+    std::ostream bufferStream_{nullptr};
+#endif
+};
+
+// === 映射输出 ===
+
+#ifdef ZIP_HAVE_MMAP
+
+// 为输出文件预留[0, size)的磁盘空间, 返回0或错误码; 文件系统不支持预分配时退回ftruncate
+static int reserveOutputFile(int fd, size_t size) {
+    int err = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (err == EINVAL || err == EOPNOTSUPP) {
+        err = ::ftruncate(fd, static_cast<off_t>(size)) == 0 ? 0 : errno;
+    }
+    return err;
+}
+
+// 按预计大小预分配输出文件并直接解压到其映射中, 省去输出缓冲区与write的拷贝; 映射按windowSize
+// 逐段建立, 写满即解除. 实际输出超出预计大小时按需扩展, 结束时截断到实际大小.
+// 输出不是普通文件或无法按预计大小预分配 (预计大小只是提示) 时不读取输入, 返回false
+static bool inflateToMappedFile(InputFile& in, const std::string& outputPath, size_t expectedSize,
+                                size_t windowSize) {
+    FdGuard out(::open(outputPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+    if (out.fd < 0) throw std::runtime_error("Failed to open output file: " + outputPath);
+    struct stat st;
+    if (::fstat(out.fd, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    
+    // 容量按页取整, 使每个映射窗口的文件偏移都按页对齐
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t capacity = (expectedSize + page - 1) / page * page;
+    windowSize = std::max(windowSize / page, size_t(1)) * page;
+    if (reserveOutputFile(out.fd, capacity) != 0) {
+        if (::ftruncate(out.fd, 0) != 0) throw std::runtime_error("Failed to write output file: " + outputPath);
+        return false;
+    }
+    
+    // 空文件解压为空文件
+    const uint8_t* data = nullptr;
+    size_t size = in.next(data);
+    if (size == 0) {
+        if (::ftruncate(out.fd, 0) != 0) throw std::runtime_error("Failed to write output file: " + outputPath);
+        return true;
+    }
+    
+    InflateState inflater(MAX_WBITS);
+    z_stream& stream = inflater.get();
+    size_t written = 0;
+    void* window = nullptr;
+    size_t windowLength = 0;
+    
+    auto unmap = [&] {
+        if (window) ::munmap(window, windowLength);
+        window = nullptr;
+    };
+    
+    try {
+        int ret = Z_OK;
+        while (size > 0) {
+            stream.next_in = const_cast<Bytef*>(data);
+            stream.avail_in = static_cast<uInt>(size);
+            
+            do {
+                // 串接的成员: 上一个成员已结束而后面还有数据
+                if (ret == Z_STREAM_END) inflateReset(&stream);
+                
+                // 当前窗口写满时映射下一段, 文件空间不足时先扩展
+                if (!window || stream.avail_out == 0) {
+                    unmap();
+                    // 加倍扩展失败时退回只扩展一个窗口
+                    if (written == capacity) {
+                        int err = reserveOutputFile(out.fd, capacity + std::max(capacity, windowSize));
+                        if (err == 0) {
+                            capacity += std::max(capacity, windowSize);
+                        } else if ((err = reserveOutputFile(out.fd, capacity + windowSize)) == 0) {
+                            capacity += windowSize;
+                        } else {
+                            throw std::runtime_error("Failed to allocate output file: " + outputPath + ": " +
+                                                     std::strerror(err));
+                        }
+                    }
+                    windowLength = std::min(windowSize, capacity - written);
+                    window = ::mmap(nullptr, windowLength, PROT_READ | PROT_WRITE, MAP_SHARED, out.fd,
+                                    static_cast<off_t>(written));
+                    if (window == MAP_FAILED) {
+                        window = nullptr;
+                        throw std::runtime_error("Failed to map output file: " + outputPath);
+                    }
+                    stream.next_out = static_cast<Bytef*>(window);
+                    stream.avail_out = static_cast<uInt>(windowLength);
+                }
+                
+                uInt before = stream.avail_out;
+                ret = inflate(&stream, Z_NO_FLUSH);
+                if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+                    ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+                    throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
+                }
+                written += before - stream.avail_out;
+            } while (stream.avail_in > 0 || (stream.avail_out == 0 && ret != Z_STREAM_END));
+            
+            size = in.next(data);
+        }
+        
+        if (ret != Z_STREAM_END) throw std::runtime_error("Decompression incomplete");
+    } catch (...) {
+        unmap();
+        throw;
+    }
+    unmap();
+    
+    if (::ftruncate(out.fd, static_cast<off_t>(written)) != 0) {
+        throw std::runtime_error("Failed to write output file: " + outputPath);
+    }
+    return true;
+}
+
+#endif // ZIP_HAVE_MMAP
+
+// === io_uring文件引擎 ===
+
+#ifdef ZIP_HAVE_IO_URING
+
+// 直接基于系统调用的最小io_uring封装 (不依赖liburing)
+class IoUring {
+public:
+    explicit IoUring(unsigned entries) {
+        io_uring_params params = {};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) throw std::runtime_error("io_uring_setup failed: " + std::string(std::strerror(errno)));
+        
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        
+        sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd_, IORING_OFF_SQ_RING);
+        cqRing_ = single ? sqRing_
+                         : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  fd_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       fd_, IORING_OFF_SQES);
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            release();
+            throw std::runtime_error("Failed to map io_uring rings");
+        }
+        
+        auto* sq = static_cast<uint8_t*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        
+        auto* cq = static_cast<uint8_t*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
     }
     
-    // 计算最大压缩大小
-    uLongf compressedSize = compressBound(data.size());
-    std::vector<uint8_t> result(compressedSize);
+    ~IoUring() { release(); }
     
-    // 执行压缩
-    int err = compress2(result.data(), &compressedSize, 
-                       data.data(), data.size(), 
-                       level);
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
     
-    // 错误处理
-    if (err != Z_OK) {
-        throw std::runtime_error("Compression failed: " + std::string(zError(err)));
+    bool registerBuffers(const iovec* buffers, unsigned count) {
+        return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers, count) == 0;
     }
     
-    result.resize(compressedSize);
-    return result;
-}
+    // 提交一个固定缓冲区读写请求
+    void submit(uint8_t opcode, int fd, void* buffer, size_t length, size_t offset,
+                unsigned bufferIndex, uint64_t userData) {
+        unsigned tail = *sqTail_;
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+            throw std::runtime_error("io_uring submission queue full");
+        }
+        
+        io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + (tail & sqMask_);
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = static_cast<uint32_t>(length);
+        sqe->off = offset;
+        sqe->buf_index = static_cast<uint16_t>(bufferIndex);
+        sqe->user_data = userData;
+        sqArray_[tail & sqMask_] = tail & sqMask_;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        
+        enter(1, 0);
+    }
+    
+    // 等待并取出一个完成事件
+    io_uring_cqe wait() {
+        for (;;) {
+            unsigned head = *cqHead_;
+            if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                io_uring_cqe cqe = cqes_[head & cqMask_];
+                __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                return cqe;
+            }
+            enter(0, 1);
+        }
+    }
+    
+private:
+    void enter(unsigned toSubmit, unsigned minComplete) {
+        unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        while (::syscall(__NR_io_uring_enter, fd_, toSubmit, minComplete, flags, nullptr, 0) < 0) {
+            if (errno != EINTR) {
+                throw std::runtime_error("io_uring_enter failed: " + std::string(std::strerror(errno)));
+            }
+        }
+    }
+    
+    void release() {
+        if (sqes_ && sqes_ != MAP_FAILED) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != MAP_FAILED && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_ && sqRing_ != MAP_FAILED) ::munmap(sqRing_, sqRingSize_);
+        sqes_ = cqRing_ = sqRing_ = nullptr;
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+    
+    int fd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    void* sqes_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
 
-// 解压实现
-std::vector<uint8_t> Zip::decompress(const std::vector<uint8_t>& compressed) {
-    if (compressed.empty()) return {};
+// 基于io_uring的文件I/O: 输入按顺序预读depth个块, 输出以depth个缓冲区异步写出, 均使用注册缓冲区
+class UringFileIo {
+public:
+    // 内核不支持io_uring (或被禁止) 时返回false
+    static bool available() {
+        static const bool supported = [] {
+            try {
+                IoUring probe(2);
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }();
+        return supported;
+    }
     
-    // 初始缓冲区大小
-    size_t bufferSize = compressed.size() * 2;
-    std::vector<uint8_t> result;
-    int err = Z_BUF_ERROR;
+    // 注册缓冲区失败 (如RLIMIT_MEMLOCK过小) 时返回nullptr
+    static std::unique_ptr<UringFileIo> create(int inFd, size_t inSize, int outFd,
+                                               size_t readSize, size_t writeSize, unsigned depth) {
+        std::unique_ptr<UringFileIo> io(new UringFileIo(inFd, inSize, outFd, readSize, writeSize, depth));
+        std::vector<iovec> iov;
+        for (auto& slot : io->reads_) iov.push_back({slot.data.data(), slot.data.size()});
+        for (auto& slot : io->writes_) iov.push_back({slot.data.data(), slot.data.size()});
+        if (!io->ring_.registerBuffers(iov.data(), static_cast<unsigned>(iov.size()))) return nullptr;
+        
+        for (unsigned i = 0; i < depth; ++i) io->startRead(i);
+        return io;
+    }
+    
+    ~UringFileIo() {
+        // 内核可能仍在访问缓冲区, 必须等所有请求完成后才能释放
+        try {
+            while (inFlight_ > 0) dispatch(ring_.wait());
+        } catch (...) {
+        }
+    }
     
-    // 最多尝试5次
-    for (int i = 0; i < 5; ++i) {
-        result.resize(bufferSize);
-        uLongf destLen = static_cast<uLongf>(result.size());
+    UringFileIo(const UringFileIo&) = delete;
+    UringFileIo& operator=(const UringFileIo&) = delete;
+    
+    // 按顺序取得下一段输入, 返回0表示结束; 上一段在本次调用后归还并用于后续预读
+    size_t next(const uint8_t*& data) {
+        if (held_ >= 0) {
+            startRead(static_cast<unsigned>(held_));
+            held_ = -1;
+        }
+        if (consumed_ >= inSize_) return 0;
         
-        err = uncompress(result.data(), &destLen, 
-                        compressed.data(), compressed.size());
+        unsigned index = static_cast<unsigned>(readCount_++ % reads_.size());
+        ReadSlot& slot = reads_[index];
+        while (slot.state == SlotState::Busy) dispatch(ring_.wait());
+        if (slot.result < 0) {
+            throw std::runtime_error("Failed to read input file: " + std::string(std::strerror(-slot.result)));
+        }
         
-        if (err == Z_OK) {
-            result.resize(destLen);
-            return result;
+        // 短读时同步补齐剩余部分
+        size_t got = static_cast<size_t>(slot.result);
+        while (got < slot.length) {
+            ssize_t n = ::pread(inFd_, slot.data.data() + got, slot.length - got,
+                                static_cast<off_t>(slot.offset + got));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error("Failed to read input file");
+            got += static_cast<size_t>(n);
         }
         
-        if (err != Z_BUF_ERROR) {
-            throw std::runtime_error("Decompression failed: " + std::string(zError(err)));
+        held_ = static_cast<int>(index);
+        consumed_ += slot.length;
+        data = slot.data.data();
+        return slot.length;
+    }
+    
+    // 取得一个空闲的输出缓冲区 (全部在途时等待完成)
+    unsigned acquireWrite() {
+        for (;;) {
+            checkWriteError();
+            for (unsigned i = 0; i < writes_.size(); ++i) {
+                if (writes_[i].state == SlotState::Idle) return i;
+            }
+            dispatch(ring_.wait());
+        }
+    }
+    
+    uint8_t* writeBuffer(unsigned index) { return writes_[index].data.data(); }
+    size_t writeCapacity() const { return writes_.front().data.size(); }
+    
+    // 异步写出缓冲区中的length字节, 写入位置按提交顺序连续递增
+    void submitWrite(unsigned index, size_t length) {
+        WriteSlot& slot = writes_[index];
+        slot.offset = writeOffset_;
+        slot.length = length;
+        slot.state = SlotState::Busy;
+        writeOffset_ += length;
+        ring_.submit(IORING_OP_WRITE_FIXED, outFd_, slot.data.data(), length, slot.offset,
+                     static_cast<unsigned>(reads_.size()) + index, tag(true, index));
+        ++inFlight_;
+    }
+    
+    // 等待全部写入完成
+    void finish() {
+        for (;;) {
+            bool busy = false;
+            for (auto& slot : writes_) busy = busy || slot.state == SlotState::Busy;
+            if (!busy) break;
+            dispatch(ring_.wait());
+        }
+        checkWriteError();
+    }
+    
+private:
+    enum class SlotState { Idle, Busy, Ready };
+    
+    struct ReadSlot {
+        std::vector<uint8_t> data;
+        size_t offset = 0;
+        size_t length = 0;
+        int result = 0;
+        SlotState state = SlotState::Idle;
+    };
+    
+    struct WriteSlot {
+        std::vector<uint8_t> data;
+        size_t offset = 0;
+        size_t length = 0;
+        SlotState state = SlotState::Idle;
+    };
+    
+    UringFileIo(int inFd, size_t inSize, int outFd, size_t readSize, size_t writeSize, unsigned depth)
+        : ring_(depth * 4), inFd_(inFd), outFd_(outFd), inSize_(inSize), reads_(depth), writes_(depth) {
+        for (auto& slot : reads_) slot.data.resize(readSize);
+        for (auto& slot : writes_) slot.data.resize(writeSize);
+    }
+    
+    static uint64_t tag(bool write, unsigned index) {
+        return (static_cast<uint64_t>(write) << 32) | index;
+    }
+    
+    // 为读取槽发起下一段预读 (输入已全部发起时置为空闲)
+    void startRead(unsigned index) {
+        ReadSlot& slot = reads_[index];
+        if (readOffset_ >= inSize_) {
+            slot.state = SlotState::Idle;
+            return;
+        }
+        slot.offset = readOffset_;
+        slot.length = std::min(slot.data.size(), inSize_ - readOffset_);
+        slot.state = SlotState::Busy;
+        readOffset_ += slot.length;
+        ring_.submit(IORING_OP_READ_FIXED, inFd_, slot.data.data(), slot.length, slot.offset,
+                     index, tag(false, index));
+        ++inFlight_;
+    }
+    
+    void dispatch(const io_uring_cqe& cqe) {
+        --inFlight_;
+        unsigned index = static_cast<unsigned>(cqe.user_data & 0xFFFFFFFFu);
+        if ((cqe.user_data >> 32) == 0) {
+            reads_[index].result = cqe.res;
+            reads_[index].state = SlotState::Ready;
+            return;
         }
         
-        // 缓冲区不足时增加50%
-        bufferSize = bufferSize * 3 / 2;
+        WriteSlot& slot = writes_[index];
+        slot.state = SlotState::Idle;
+        if (cqe.res < 0) {
+            if (writeError_ == 0) writeError_ = -cqe.res;
+            return;
+        }
+        // 短写时同步补齐剩余部分
+        size_t done = static_cast<size_t>(cqe.res);
+        while (done < slot.length && writeError_ == 0) {
+            ssize_t n = ::pwrite(outFd_, slot.data.data() + done, slot.length - done,
+                                 static_cast<off_t>(slot.offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) writeError_ = n < 0 ? errno : EIO;
+            else done += static_cast<size_t>(n);
+        }
+    }
+    
+    void checkWriteError() {
+        if (writeError_ != 0) {
+            throw std::runtime_error("Failed to write output file: " + std::string(std::strerror(writeError_)));
+        }
+    }
+    
+    IoUring ring_;
+    int inFd_;
+    int outFd_;
+    size_t inSize_;
+    size_t readOffset_ = 0;
+    size_t readCount_ = 0;
+    size_t consumed_ = 0;
+    int held_ = -1;
+    size_t writeOffset_ = 0;
+    int writeError_ = 0;
+    size_t inFlight_ = 0;
+    std::vector<ReadSlot> reads_;
+    std::vector<WriteSlot> writes_;
+};
+
+// 把ostream写入转成io_uring异步写: 写满一个注册缓冲区即提交, 不等待完成
+class UringOutputBuf : public std::streambuf {
+public:
+    explicit UringOutputBuf(UringFileIo& io)
+        : io_(io) {
+        reset();
+    }
+    
+    // ostream会吞掉overflow/sync中的异常, 由调用方在刷新后检查并重新抛出
+    void checkError() {
+        if (error_) std::rethrow_exception(error_);
+    }
+    
+protected:
+    int_type overflow(int_type ch) override {
+        if (!trySubmit()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    
+    int sync() override {
+        return trySubmit() ? 0 : -1;
+    }
+    
+private:
+    bool trySubmit() {
+        if (error_) return false;
+        try {
+            submit();
+            return true;
+        } catch (...) {
+            error_ = std::current_exception();
+            return false;
+        }
+    }
+    
+    void submit() {
+        size_t length = static_cast<size_t>(pptr() - pbase());
+        if (length == 0) return;
+        io_.submitWrite(current_, length);
+        reset();
     }
     
-    throw std::runtime_error("Decompression failed: output buffer too small after multiple attempts");
+    void reset() {
+        current_ = io_.acquireWrite();
+        char* base = reinterpret_cast<char*>(io_.writeBuffer(current_));
+        setp(base, base + io_.writeCapacity());
+    }
+    
+    UringFileIo& io_;
+    unsigned current_ = 0;
+    std::exception_ptr error_;
+};
+
+// 在io_uring引擎上执行文件转换, transform(source, output)完成实际的压缩或解压;
+// 输入不是普通文件、内核不支持或缓冲区无法注册时返回false, 由调用方退回阻塞I/O
+template <typename Transform>
+static bool transformFileUring(const std::string& inputPath, const std::string& outputPath,
+                               size_t windowSize, size_t outSize, Transform&& transform) {
+    constexpr unsigned DEPTH = 4;
+    if (!UringFileIo::available()) return false;
+    
+    // 打开前先检查类型: 打开再关闭FIFO会丢失写入端已发送的数据
+    struct stat st;
+    if (::stat(inputPath.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    
+    FdGuard in(::open(inputPath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0) throw std::runtime_error("Failed to open input file: " + inputPath);
+    if (::fstat(in.fd, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    
+    FdGuard out(::open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+    if (out.fd < 0) throw std::runtime_error("Failed to open output file: " + outputPath);
+    
+    // 空文件得到空文件
+    size_t inSize = static_cast<size_t>(st.st_size);
+    if (inSize == 0) return true;
+    
+    auto io = UringFileIo::create(in.fd, inSize, out.fd, windowSize / DEPTH, outSize / DEPTH, DEPTH);
+    if (!io) return false;
+    
+    {
+        UringOutputBuf buffer(*io);
+        std::ostream output(&buffer);
+        transform([&](const uint8_t*& data) { return io->next(data); }, output);
+        output.flush();
+        buffer.checkError();
+        if (!output) throw std::runtime_error("Failed to write output file: " + outputPath);
+    }
+    io->finish();
+    return true;
 }
 
-// 压缩字符串
-std::vector<uint8_t> Zip::compressString(const std::string& str, int level) {
-    std::vector<uint8_t> data(str.begin(), str.end());
-    return compress(data, level);
+#endif // ZIP_HAVE_IO_URING
+
+bool Zip::ioUringAvailable() {
+#ifdef ZIP_HAVE_IO_URING
+    return UringFileIo::available();
+#else
+    return false;
+#endif
 }
 
-// 解压字符串
-std::string Zip::decompressString(const std::vector<uint8_t>& compressed) {
-    auto decompressed = decompress(compressed);
-    return std::string(reinterpret_cast<char*>(decompressed.data()), decompressed.size());
+// 按内存上限划分输入窗口(1/2)与输出缓冲区(1/4), 其余留给zlib内部状态
+static void splitMemoryLimit(size_t memoryLimit, size_t& windowSize, size_t& outSize) {
+    constexpr size_t MIN_BUFFER = 64 * 1024;
+    constexpr size_t MAX_BUFFER = 1024 * 1024 * 1024;
+    windowSize = std::min(std::max(memoryLimit / 2, MIN_BUFFER), MAX_BUFFER);
+    outSize = std::min(std::max(memoryLimit / 4, MIN_BUFFER), MAX_BUFFER);
 }
 
 // 压缩文件
 void Zip::compressFile(const std::string& inputPath, const std::string& outputPath, int level) {
-    // 读取文件内容
-    std::ifstream in(inputPath, std::ios::binary);
-    if (!in) throw std::runtime_error("Failed to open input file: " + inputPath);
+    compressFile(inputPath, outputPath, level, FileOptions());
+}
+
+// 压缩文件 (流式, 内存占用与文件大小无关)
+void Zip::compressFile(const std::string& inputPath, const std::string& outputPath, int level,
+                       const FileOptions& options) {
+    checkLevel(level);
+    
+    size_t windowSize, outSize;
+    splitMemoryLimit(options.memoryLimit, windowSize, outSize);
+    unsigned threads = resolveThreads(options.threads);
+    size_t blockSize = std::min(std::max(options.blockSize, DICT_SIZE), MAX_CHUNK);
+    
+    // 并行压缩约占用 4 * threads * blockSize, 按memoryLimit限制线程数 (不足两个线程时退回单线程)
+    size_t maxThreads = options.memoryLimit / 4 / blockSize;
+    if (threads > maxThreads) threads = static_cast<unsigned>(std::max<size_t>(maxThreads, 1));
+    
+#ifdef ZIP_HAVE_IO_URING
+    if (options.ioEngine == IoEngine::IoUring && !options.directIo && threads == 1 && !options.pipelined &&
+        transformFileUring(inputPath, outputPath, windowSize, outSize,
+                           [&](auto&& source, std::ostream& out) {
+                               DeflateState deflater(level, MAX_WBITS);
+                               deflateChunks(deflater.get(), source, out, outSize);
+                           })) {
+        return;
+    }
+#endif
+    
+    // 流水线模式的读取线程共享持有输入文件 (出错时它可能晚于本函数结束)
+    auto in = std::make_shared<InputFile>(inputPath, threads > 1 ? blockSize : windowSize, options.directIo);
+    OutputFile output(outputPath, options.directIo);
+    std::ostream& out = output.stream();
     
-    std::vector<uint8_t> data(
-        (std::istreambuf_iterator<char>(in)),
-        std::istreambuf_iterator<char>()
-    );
+    if (threads > 1) {
+        // 并行模式: 先读入第一块, 空文件仍压缩为空文件
+        std::vector<uint8_t> first(blockSize);
+        size_t firstSize = in->read(first.data(), first.size());
+        if (firstSize > 0) {
+            ParallelDeflater deflater(level, threads, blockSize, out);
+            deflater.run([&](uint8_t* buffer, size_t size) {
+                if (firstSize > 0) {
+                    std::copy(first.begin(), first.begin() + firstSize, buffer);
+                    size_t n = firstSize;
+                    firstSize = 0;
+                    return n;
+                }
+                return in->read(buffer, size);
+            });
+        }
+        output.close();
+        return;
+    }
     
-    // 压缩数据
-    auto compressed = compress(data, level);
+    if (options.pipelined) {
+        DeflateState deflater(level, MAX_WBITS);
+        deflatePipelined(deflater.get(),
+            [in](uint8_t* buffer, size_t size) { return in->read(buffer, size); },
+            [&](const uint8_t* data, size_t size) {
+                if (!out.write(reinterpret_cast<const char*>(data), size)) {
+                    throw std::runtime_error("Failed to write output file: " + outputPath);
+                }
+            },
+            windowSize / PIPELINE_DEPTH, outSize / PIPELINE_DEPTH, PIPELINE_DEPTH, true);
+        output.close();
+        return;
+    }
     
-    // 写入压缩文件
-    std::ofstream out(outputPath, std::ios::binary);
-    if (!out) throw std::runtime_error("Failed to open output file: " + outputPath);
+    // 空文件压缩为空文件
+    const uint8_t* first = nullptr;
+    size_t firstSize = in->next(first);
+    if (firstSize > 0) {
+        DeflateState deflater(level, MAX_WBITS);
+        deflateChunks(deflater.get(), [&](const uint8_t*& data) {
+            if (first) {
+                data = first;
+                first = nullptr;
+                return firstSize;
+            }
+            return in->next(data);
+        }, out, outSize);
+    }
     
-    out.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+    output.close();
 }
 
+#ifdef ZIP_HAVE_MMAP
+// 按窗口映射的只读文件, 供并行解压按偏移访问输入: 访问窗口之外时重新映射, 常驻的输入不超过窗口大小
+class MappedWindow {
+public:
+    MappedWindow(int fd, size_t fileSize, size_t windowSize)
+        : fd_(fd), fileSize_(fileSize), page_(static_cast<size_t>(::sysconf(_SC_PAGESIZE))) {
+        windowSize_ = std::max(windowSize / page_, size_t(2)) * page_;
+    }
+    
+    ~MappedWindow() { unmap(); }
+    
+    MappedWindow(const MappedWindow&) = delete;
+    MappedWindow& operator=(const MappedWindow&) = delete;
+    
+    // offset处起连续可读的数据及其长度; 除文件末尾外至少一页
+    const uint8_t* at(size_t offset, size_t& length) {
+        size_t end = base_ + length_;
+        if (!window_ || offset < base_ || offset >= end || (offset + page_ > end && end < fileSize_)) {
+            unmap();
+            // 映射偏移必须按页对齐
+            base_ = offset / page_ * page_;
+            length_ = std::min(windowSize_, fileSize_ - base_);
+            void* window = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd_, static_cast<off_t>(base_));
+            if (window == MAP_FAILED) throw std::runtime_error("Failed to map input file");
+            ::madvise(window, length_, MADV_SEQUENTIAL);
+            window_ = static_cast<const uint8_t*>(window);
+        }
+        length = base_ + length_ - offset;
+        return window_ + (offset - base_);
+    }
+    
+private:
+    void unmap() {
+        if (window_) ::munmap(const_cast<uint8_t*>(window_), length_);
+        window_ = nullptr;
+    }
+    
+    int fd_;
+    size_t fileSize_;
+    size_t page_;
+    size_t windowSize_;
+    const uint8_t* window_ = nullptr;
+    size_t base_ = 0;
+    size_t length_ = 0;
+};
+#endif
+
 // 解压文件
 void Zip::decompressFile(const std::string& inputPath, const std::string& outputPath) {
-    // 读取压缩文件
-    std::ifstream in(inputPath, std::ios::binary);
-    if (!in) throw std::runtime_error("Failed to open input file: " + inputPath);
+    decompressFile(inputPath, outputPath, FileOptions());
+}
+
+// 解压文件 (流式, 内存占用与文件大小及解压后大小无关)
+void Zip::decompressFile(const std::string& inputPath, const std::string& outputPath,
+                         const FileOptions& options) {
+    size_t windowSize, outSize;
+    splitMemoryLimit(options.memoryLimit, windowSize, outSize);
     
-    std::vector<uint8_t> compressed(
-        (std::istreambuf_iterator<char>(in)),
-        std::istreambuf_iterator<char>()
-    );
+#ifdef ZIP_HAVE_MMAP
+    // 多线程: 普通文件的输入由各线程按窗口映射, 串接的成员并行解压; 输入窗口合计占用windowSize,
+    // 按顺序解压的缓冲区与各线程暂存的输出各占outSize的一半. 指定了其他解压路径的选项时不使用.
+    // 打开前先检查类型: 打开再关闭FIFO会丢失写入端已发送的数据
+    unsigned threads = resolveThreads(options.threads);
+    struct stat st;
+    if (threads > 1 && !options.directIo && options.outputSize == 0 && !options.inflateBack &&
+        options.ioEngine != IoEngine::IoUring && ::stat(inputPath.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        FdGuard in(::open(inputPath.c_str(), O_RDONLY | O_CLOEXEC));
+        if (in.fd < 0) throw std::runtime_error("Failed to open input file: " + inputPath);
+        if (::fstat(in.fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            size_t size = static_cast<size_t>(st.st_size);
+            size_t window = std::max(windowSize / threads, MEMBER_SEGMENT_MIN);
+            OutputFile output(outputPath, false, options.sparse);
+            inflateMembersParallel(size, [&] { return MappedWindow(in.fd, size, window); }, threads, window,
+                                   std::max(outSize / 2 / threads, MEMBER_SEGMENT_MIN), outSize / 2,
+                                   OstreamSink{output.stream()});
+            output.close();
+            return;
+        }
+    }
+#endif
     
-    // 解压数据
-    auto decompressed = decompress(compressed);
+#ifdef ZIP_HAVE_IO_URING
+    if (options.ioEngine == IoEngine::IoUring && !options.directIo && !options.sparse && options.outputSize == 0 &&
+        transformFileUring(inputPath, outputPath, windowSize, outSize,
+                           [&](auto&& source, std::ostream& out) {
+                               if (options.inflateBack) {
+                                   inflateBackTo(source, OstreamSink{out});
+                                   return;
+                               }
+                               InflateState inflater(MAX_WBITS);
+                               inflateChunks(inflater.get(), source, out, outSize);
+                           })) {
+        return;
+    }
+#endif
     
-    // 写入解压文件
-    std::ofstream out(outputPath, std::ios::binary);
-    if (!out) throw std::runtime_error("Failed to open output file: " + outputPath);
+    InputFile in(inputPath, windowSize, options.directIo);
     
-    out.write(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
+#ifdef ZIP_HAVE_MMAP
+    if (options.outputSize > 0 && !options.directIo && !options.sparse &&
+        inflateToMappedFile(in, outputPath, options.outputSize, outSize)) {
+        return;
+    }
+#endif
+    
+    OutputFile output(outputPath, options.directIo, options.sparse);
+    std::ostream& out = output.stream();
+    
+    // 空文件解压为空文件
+    const uint8_t* first = nullptr;
+    size_t firstSize = in.next(first);
+    if (firstSize > 0) {
+        auto source = [&](const uint8_t*& data) {
+            if (first) {
+                data = first;
+                first = nullptr;
+                return firstSize;
+            }
+            return in.next(data);
+        };
+        if (options.inflateBack) {
+            inflateBackTo(source, OstreamSink{out});
+        } else {
+            InflateState inflater(MAX_WBITS);
+            inflateChunks(inflater.get(), source, out, outSize);
+        }
+    }
+    
+    output.close();
 }
 
-// 流式压缩
-void Zip::compressStream(std::istream& input, std::ostream& output, int level) {
-    constexpr size_t CHUNK_SIZE = 64 * 1024; // 64KB
-    std::vector<uint8_t> inBuf(CHUNK_SIZE);
-    std::vector<uint8_t> outBuf(CHUNK_SIZE * 2);
+// === 文件描述符I/O ===
+
+#ifdef ZIP_HAVE_MMAP
+
+// 直接read(2)的数据源, 适用于普通文件、管道、套接字与memfd
+class FdSource {
+public:
+    FdSource(int fd, size_t bufferSize)
+        : fd_(fd), buffer_(bufferSize) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
     
-    z_stream stream = {};
-    if (deflateInit2(&stream, level, Z_DEFLATED, MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-        throw std::runtime_error("deflateInit failed: " + std::string(zError(stream.avail_in)));
+    size_t operator()(const uint8_t*& data) {
+        for (;;) {
+            ssize_t n = ::read(fd_, buffer_.data(), buffer_.size());
+            if (n >= 0) {
+                data = buffer_.data();
+                return static_cast<size_t>(n);
+            }
+            if (errno != EINTR) {
+                throw std::runtime_error("Failed to read input fd: " + std::string(std::strerror(errno)));
+            }
+        }
     }
     
-    auto cleanup = [&] { deflateEnd(&stream); };
+private:
+    int fd_;
+    AlignedBuffer buffer_;
+};
+
+// 直接write(2)的输出端, 处理短写与EINTR
+struct FdSink {
+    int fd;
     
-    try {
-        int flush;
-        do {
-            input.read(reinterpret_cast<char*>(inBuf.data()), CHUNK_SIZE);
-            stream.avail_in = static_cast<uInt>(input.gcount());
-            flush = input.eof() ? Z_FINISH : Z_NO_FLUSH;
-            stream.next_in = inBuf.data();
-            
-            do {
-                stream.avail_out = static_cast<uInt>(outBuf.size());
-                stream.next_out = outBuf.data();
-                
-                int err = deflate(&stream, flush);
-                if (err == Z_STREAM_ERROR) {
-                    throw std::runtime_error("Compression error: " + std::string(zError(err)));
-                }
-                
-                size_t have = outBuf.size() - stream.avail_out;
-                output.write(reinterpret_cast<const char*>(outBuf.data()), have);
-            } while (stream.avail_out == 0);
-        } while (flush != Z_FINISH);
-    } catch (...) {
-        cleanup();
-        throw;
+    void operator()(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Failed to write output fd: " + std::string(std::strerror(errno)));
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
     }
-    
-    cleanup();
+};
+
+// 描述符是否以直接I/O打开 (此时写出需要按块对齐)
+static bool isDirectFd(int fd) {
+#ifdef O_DIRECT
+    int flags = ::fcntl(fd, F_GETFL);
+    return flags >= 0 && (flags & O_DIRECT) != 0;
+#else
+    (void)fd;
+    return false;
+#endif
 }
 
-// 流式解压
-void Zip::decompressStream(std::istream& input, std::ostream& output) {
-    constexpr size_t CHUNK_SIZE = 64 * 1024; // 64KB
-    std::vector<uint8_t> inBuf(CHUNK_SIZE);
-    std::vector<uint8_t> outBuf(CHUNK_SIZE * 2);
+// 基于文件描述符压缩
+void Zip::compressFd(int inFd, int outFd, int level) {
+    checkLevel(level);
+    FdSource source(inFd, FD_BUFFER_SIZE);
+    AlignedBuffer outBuf(FD_BUFFER_SIZE);
+    DeflateState deflater(level, MAX_WBITS);
+    if (isDirectFd(outFd)) {
+        DirectOutputBuf direct(outFd, FD_BUFFER_SIZE);
+        deflateChunksTo(deflater.get(), source, [&](const uint8_t* data, size_t size) { direct.write(data, size); },
+                        outBuf.data(), outBuf.size());
+        direct.finish();
+        return;
+    }
+    deflateChunksTo(deflater.get(), source, FdSink{outFd},
+                    outBuf.data(), outBuf.size());
+}
+
+// 基于文件描述符解压
+void Zip::decompressFd(int inFd, int outFd) {
+    FdSource source(inFd, FD_BUFFER_SIZE);
+    AlignedBuffer outBuf(FD_BUFFER_SIZE);
+    InflateState inflater(MAX_WBITS);
+    if (isDirectFd(outFd)) {
+        DirectOutputBuf direct(outFd, FD_BUFFER_SIZE);
+        inflateChunksTo(inflater.get(), source, [&](const uint8_t* data, size_t size) { direct.write(data, size); },
+                        outBuf.data(), outBuf.size());
+        direct.finish();
+        return;
+    }
+    inflateChunksTo(inflater.get(), source, FdSink{outFd},
+                    outBuf.data(), outBuf.size());
+}
+
+#endif // ZIP_HAVE_MMAP
+
+// === 批量文件操作 ===
+
+// 批量压缩
+Zip::BatchResult Zip::compressFiles(const std::vector<std::pair<std::string, std::string>>& files,
+                                    int level) {
+    return compressFiles(files, level, BatchOptions());
+}
+
+// 批量压缩 (工作线程池, 按文件大小从大到小调度以缩短尾部等待)
+Zip::BatchResult Zip::compressFiles(const std::vector<std::pair<std::string, std::string>>& files,
+                                    int level, const BatchOptions& options) {
+    checkLevel(level);
+    auto start = std::chrono::steady_clock::now();
     
-    z_stream stream = {};
-    if (inflateInit2(&stream, MAX_WBITS) != Z_OK) {
-        throw std::runtime_error("inflateInit failed: " + std::string(zError(stream.avail_in)));
+    BatchResult result;
+    result.files.resize(files.size());
+    std::vector<size_t> order(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        FileResult& file = result.files[i];
+        file.inputPath = files[i].first;
+        file.outputPath = files[i].second;
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file.inputPath, ec);
+        file.inputSize = ec ? 0 : static_cast<uint64_t>(size);
+        order[i] = i;
     }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return result.files[a].inputSize > result.files[b].inputSize;
+    });
     
-    auto cleanup = [&] { inflateEnd(&stream); };
+    FileOptions fileOptions = options.file;
+    fileOptions.threads = 1;
+    unsigned threads = static_cast<unsigned>(
+        std::min<size_t>(resolveThreads(options.threads), std::max<size_t>(files.size(), 1)));
+    std::atomic<size_t> next{0};
     
-    try {
-        int ret;
-        do {
-            input.read(reinterpret_cast<char*>(inBuf.data()), CHUNK_SIZE);
-            stream.avail_in = static_cast<uInt>(input.gcount());
-            if (stream.avail_in == 0) break;
-            stream.next_in = inBuf.data();
-            
-            do {
-                stream.avail_out = static_cast<uInt>(outBuf.size());
-                stream.next_out = outBuf.data();
-                ret = inflate(&stream, Z_NO_FLUSH);
-                
-                if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || 
-                    ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
-                    throw std::runtime_error("Decompression error: " + std::string(zError(ret)));
-                }
-                
-                size_t have = outBuf.size() - stream.avail_out;
-                output.write(reinterpret_cast<const char*>(outBuf.data()), have);
-            } while (stream.avail_out == 0);
-        } while (ret != Z_STREAM_END);
-        
-        if (ret != Z_STREAM_END) {
-            throw std::runtime_error("Decompression incomplete");
+    runWorkers(threads, [&](unsigned) {
+        for (size_t i = next++; i < order.size(); i = next++) {
+            FileResult& file = result.files[order[i]];
+            auto fileStart = std::chrono::steady_clock::now();
+            try {
+                compressFile(file.inputPath, file.outputPath, level, fileOptions);
+                std::error_code ec;
+                auto size = std::filesystem::file_size(file.outputPath, ec);
+                file.outputSize = ec ? 0 : static_cast<uint64_t>(size);
+            } catch (const std::exception& e) {
+                file.error = e.what();
+            }
+            file.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStart).count();
         }
-    } catch (...) {
-        cleanup();
-        throw;
+    });
+    
+    for (const FileResult& file : result.files) {
+        if (file.ok()) {
+            result.totalInput += file.inputSize;
+            result.totalOutput += file.outputSize;
+        } else {
+            ++result.failed;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// 压缩目录
+Zip::BatchResult Zip::compressDirectory(const std::string& directory, const std::string& suffix,
+                                        int level) {
+    return compressDirectory(directory, suffix, level, BatchOptions());
+}
+
+// 压缩目录 (递归收集普通文件后交给compressFiles)
+Zip::BatchResult Zip::compressDirectory(const std::string& directory, const std::string& suffix,
+                                        int level, const BatchOptions& options) {
+    if (suffix.empty()) throw std::invalid_argument("Output suffix must not be empty");
+    
+    std::vector<std::pair<std::string, std::string>> files;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(directory, ec), end;
+    if (ec) throw std::runtime_error("Failed to open directory: " + directory);
+    
+    for (; it != end; it.increment(ec)) {
+        if (ec) throw std::runtime_error("Failed to read directory: " + directory);
+        if (!it->is_regular_file(ec)) continue;
+        
+        std::string path = it->path().string();
+        bool compressed = path.size() >= suffix.size() &&
+                          path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+        if (!compressed) files.emplace_back(path, path + suffix);
+    }
+    std::sort(files.begin(), files.end());
+    
+    return compressFiles(files, level, options);
+}
+
+// 流式压缩
+void Zip::compressStream(std::istream& input, std::ostream& output, int level) {
+    cachedCompressor(level)->compressStream(input, output);
+}
+
+// 流式压缩 (带选项)
+void Zip::compressStream(std::istream& input, std::ostream& output, int level,
+                         const StreamOptions& options) {
+    unsigned threads = resolveThreads(options.threads);
+    if ((!options.pipelined && threads == 1) || options.autoFlush.enabled()) {
+        cachedCompressor(level)->compressStream(input, output, options);
+        return;
     }
     
-    cleanup();
+    checkLevel(level);
+    checkStreamOptions(options);
+    
+    // 多线程: 按blockSize读入定长块并行压缩, 按顺序写出; 空输入也输出完整的zlib流
+    if (threads > 1) {
+        size_t blockSize = std::min(std::max(options.blockSize, DICT_SIZE), MAX_CHUNK);
+        ParallelDeflater deflater(level, threads, blockSize, output);
+        deflater.run([&](uint8_t* buffer, size_t size) {
+            input.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+            return static_cast<size_t>(input.gcount());
+        });
+        if (!output) throw std::runtime_error("Failed to write output stream");
+        return;
+    }
+    
+    DeflateState deflater(level, MAX_WBITS);
+    deflatePipelined(deflater.get(),
+        [&](uint8_t* buffer, size_t size) {
+            input.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+            return static_cast<size_t>(input.gcount());
+        },
+        [&](const uint8_t* data, size_t size) {
+            if (!output.write(reinterpret_cast<const char*>(data), size)) {
+                throw std::runtime_error("Failed to write output stream");
+            }
+        },
+        options.inputBufferSize, options.outputBufferSize, PIPELINE_DEPTH, false);
+}
+
+// 流式解压
+void Zip::decompressStream(std::istream& input, std::ostream& output) {
+    cachedDecompressor()->decompressStream(input, output);
+}
+
+// 流式解压 (带选项)
+void Zip::decompressStream(std::istream& input, std::ostream& output, const StreamOptions& options) {
+    if (options.inflateBack) {
+        checkStreamOptions(options);
+        inflateBackTo(StreamSource(input, options.inputBufferSize, options.inputBuffer, options.adaptive),
+                      OstreamSink{output});
+        return;
+    }
+    cachedDecompressor()->decompressStream(input, output, options);
 }
 
 // 检查是否为zlib格式
@@ -221,4 +3966,111 @@ bool Zip::isZlibFormat(const std::vector<uint8_t>& data) {
 double Zip::compressionRatio(size_t originalSize, size_t compressedSize) {
     if (originalSize == 0) return 0.0;
     return static_cast<double>(compressedSize) / originalSize * 100.0;
-}
\ No newline at end of file
+}
+
+// === 异步接口 ===
+
+// 专用的压缩线程池: 固定数量的线程按提交顺序执行任务, 析构时执行完排队的任务后退出
+class AsyncPool {
+public:
+    explicit AsyncPool(unsigned threads) {
+        workers_.reserve(threads);
+        try {
+            for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this] { work(); });
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+    
+    ~AsyncPool() { stop(); }
+    
+    AsyncPool(const AsyncPool&) = delete;
+    AsyncPool& operator=(const AsyncPool&) = delete;
+    
+    void submit(std::function<void()> task) { tasks_.push(std::move(task)); }
+    
+private:
+    void work() {
+        std::function<void()> task;
+        while (tasks_.pop(task)) task();
+    }
+    
+    void stop() {
+        tasks_.close();
+        for (auto& worker : workers_) worker.join();
+        workers_.clear();
+    }
+    
+    BlockingQueue<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+};
+
+static std::mutex asyncMutex;
+static std::unique_ptr<AsyncPool> asyncPool;
+static unsigned asyncThreads = 0;
+
+void Zip::setAsyncThreads(unsigned threads) {
+    std::unique_ptr<AsyncPool> old;
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        asyncThreads = threads;
+        old = std::move(asyncPool);
+    }
+}
+
+void Zip::runAsync(std::function<void()> work, AsyncCallback done) {
+    if (!work) throw std::invalid_argument("Async work must not be empty");
+    
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    if (!asyncPool) asyncPool.reset(new AsyncPool(resolveThreads(asyncThreads)));
+    asyncPool->submit([work = std::move(work), done = std::move(done)] {
+        std::exception_ptr error;
+        try {
+            work();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (!done) return;
+        try {
+            done(error);
+        } catch (...) {
+        }
+    });
+}
+
+void Zip::compressFileAsync(const std::string& inputPath, const std::string& outputPath, int level,
+                            const FileOptions& options, AsyncCallback done) {
+    runAsync([=] { compressFile(inputPath, outputPath, level, options); }, std::move(done));
+}
+
+void Zip::decompressFileAsync(const std::string& inputPath, const std::string& outputPath,
+                              const FileOptions& options, AsyncCallback done) {
+    runAsync([=] { decompressFile(inputPath, outputPath, options); }, std::move(done));
+}
+
+void Zip::compressStreamAsync(std::istream& input, std::ostream& output, int level,
+                              const StreamOptions& options, AsyncCallback done) {
+    runAsync([&input, &output, level, options] { compressStream(input, output, level, options); }, std::move(done));
+}
+
+void Zip::decompressStreamAsync(std::istream& input, std::ostream& output, AsyncCallback done) {
+    runAsync([&input, &output] { decompressStream(input, output); }, std::move(done));
+}
+
+// 结果经共享的vector从任务交给回调
+void Zip::compressAsync(std::vector<uint8_t> data, int level, AsyncResultCallback done) {
+    auto result = std::make_shared<std::vector<uint8_t>>();
+    runAsync([result, data = std::move(data), level] { *result = compress(data, level); },
+             [result, done = std::move(done)](std::exception_ptr error) {
+                 if (done) done(std::move(*result), error);
+             });
+}
+
+void Zip::decompressAsync(std::vector<uint8_t> compressed, AsyncResultCallback done) {
+    auto result = std::make_shared<std::vector<uint8_t>>();
+    runAsync([result, compressed = std::move(compressed)] { *result = decompress(compressed); },
+             [result, done = std::move(done)](std::exception_ptr error) {
+                 if (done) done(std::move(*result), error);
+             });
+}
@@ -4,7 +4,25 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <memory>
+#include <utility>
+#include <iosfwd>
+#include <istream>
+#include <ostream>
 #include <stdexcept>
+#include <functional>
+#include <exception>
+#if defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define ZIP_HAVE_COROUTINES 1
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#endif
+#endif
 
 // 注意：实际实现使用zlib格式（deflate压缩），不是ZIP归档格式
 class Zip {
@@ -14,9 +32,48 @@ public:
     // 压缩数据 (一行代码)
     static std::vector<uint8_t> compress(const std::vector<uint8_t>& data, int level = 6);
     
-    // 解压数据 (一行代码)
+    // 解压数据 (一行代码); 串接的多个zlib流 (成员) 依次解压并拼接, 成员之后的数据必须是下一个成员
     static std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressed);
     
+    // 解压数据 (expectedSize为已知的原始大小, 0表示未知; 输出超过maxOutputSize时抛出异常)
+    static std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressed,
+                                           size_t expectedSize, size_t maxOutputSize = SIZE_MAX);
+    
+    // === 缓冲区操作 (写入调用方提供的内存, 不返回新vector) ===
+    
+    // 压缩结果的最大可能大小 (用于预先分配输出缓冲区); 只适用于zlib格式,
+    // 以其他windowBits (gzip/raw) 构造的Compressor可能超出此值
+    static size_t compressBound(size_t sourceSize);
+    
+    // 压缩到调用方缓冲区, 返回写入字节数 (空间不足时抛出异常)
+    static size_t compress(const uint8_t* data, size_t size,
+                           uint8_t* output, size_t outputCapacity, int level = 6);
+    
+    // 解压到调用方缓冲区, 返回写入字节数 (空间不足时抛出异常)
+    static size_t decompress(const uint8_t* compressed, size_t size,
+                             uint8_t* output, size_t outputCapacity);
+    
+#ifdef __cpp_lib_span
+    static size_t compress(std::span<const uint8_t> data, std::span<uint8_t> output, int level = 6) {
+        return compress(data.data(), data.size(), output.data(), output.size(), level);
+    }
+    
+    static size_t decompress(std::span<const uint8_t> compressed, std::span<uint8_t> output) {
+        return decompress(compressed.data(), compressed.size(), output.data(), output.size());
+    }
+#endif
+    
+    // === 并行压缩 ===
+    
+    // 多线程分块压缩 (threads为0时使用硬件线程数); 每块以前一块末尾32KB为字典,
+    // 输出为单个标准zlib流, 可由decompress或任意zlib实现解压
+    static std::vector<uint8_t> compressParallel(const std::vector<uint8_t>& data, int level = 6,
+                                                 unsigned threads = 0, size_t blockSize = 1024 * 1024);
+    
+    // 多线程解压串接的多个zlib流 (成员); 各线程在输入中定位成员边界后并行解压, 结果按顺序拼接.
+    // 只有一个成员时退化为单线程解压
+    static std::vector<uint8_t> decompressParallel(const std::vector<uint8_t>& compressed, unsigned threads = 0);
+    
     // === 字符串操作 ===
     
     // 压缩字符串 (仅适用于不含空字符的文本数据)
@@ -27,19 +84,183 @@ public:
     
     // === 文件操作 ===
     
+    // 文件I/O引擎
+    enum class IoEngine {
+        Blocking,   // 阻塞式读写
+        IoUring     // Linux io_uring异步读写 (注册缓冲区, 预读与写出和压缩重叠); 不可用时自动退回Blocking
+    };
+    
+    // 当前内核是否支持io_uring引擎
+    static bool ioUringAvailable();
+    
+    // 文件操作选项
+    struct FileOptions {
+        // 输入窗口与输出缓冲区占用内存的上限 (不含zlib内部状态), 与文件大小无关
+        size_t memoryLimit = 8 * 1024 * 1024;
+        
+        // 压缩线程数 (0表示硬件线程数, 1表示单线程); 多线程时按blockSize分块并行压缩,
+        // 输出仍是单个标准zlib流, 内存占用约为 4 * threads * blockSize;
+        // 线程数不超过 memoryLimit / (4 * blockSize), 不足2时按单线程压缩.
+        // 解压普通文件时, 第一个成员之后仍有数据则多线程并行解压串接的成员: 输入按窗口映射,
+        // 各线程暂存的输出合计不超过 memoryLimit/8, 超出的成员按顺序流式解压.
+        // 启用directIo、outputSize、inflateBack或io_uring引擎时按单线程解压; 多线程解压仅用于POSIX平台
+        unsigned threads = 0;
+        size_t blockSize = 128 * 1024;
+        
+        // 单线程压缩时启用流水线: 读取线程、压缩、写入线程三段并行, 使磁盘I/O与压缩重叠
+        bool pipelined = false;
+        
+        // I/O引擎; io_uring用于普通文件的单线程非流水线路径, 其他情况使用阻塞I/O.
+        // 解压时选择io_uring即不使用多线程 (不受threads影响)
+        IoEngine ioEngine = IoEngine::Blocking;
+        
+        // 已知的解压后大小 (0表示未知); 解压文件时据此预分配输出文件并直接解压到其内存映射中,
+        // 仅作为提示: 实际大小不同时自动扩展或截断
+        size_t outputSize = 0;
+        
+        // 直接I/O (O_DIRECT): 读写绕过页缓存, 使用对齐的缓冲区, 不足一块的文件尾部单独写出;
+        // 文件系统不支持时退回普通I/O. 启用时忽略ioEngine与outputSize
+        bool directIo = false;
+        
+        // 稀疏输出: 解压文件时把全零的4KB块写成空洞而不实际写入, 适用于大部分为零的镜像文件;
+        // 启用时忽略ioEngine与outputSize
+        bool sparse = false;
+        
+        // 解压文件改用inflateBack: 直接解码到32KB窗口并逐窗口写出, 不经过输出缓冲区.
+        // 是否更快取决于zlib的实现, 因此默认关闭; 启用时不使用多线程解压 (不受threads影响),
+        // 使用outputSize的映射输出时不生效
+        bool inflateBack = false;
+    };
+    
     // 压缩文件 (生成zlib格式)
     static void compressFile(const std::string& inputPath, const std::string& outputPath, int level = 6);
+    static void compressFile(const std::string& inputPath, const std::string& outputPath, int level,
+                             const FileOptions& options);
     
     // 解压文件 (处理zlib格式)
     static void decompressFile(const std::string& inputPath, const std::string& outputPath);
+    static void decompressFile(const std::string& inputPath, const std::string& outputPath,
+                               const FileOptions& options);
+    
+    // === 批量文件操作 ===
+    
+    // 单个文件的批量处理结果
+    struct FileResult {
+        std::string inputPath;
+        std::string outputPath;
+        uint64_t inputSize = 0;
+        uint64_t outputSize = 0;
+        double seconds = 0;
+        std::string error;      // 为空表示成功
+        
+        bool ok() const { return error.empty(); }
+    };
+    
+    // 批量处理结果, files与输入顺序一致
+    struct BatchResult {
+        std::vector<FileResult> files;
+        uint64_t totalInput = 0;
+        uint64_t totalOutput = 0;
+        double seconds = 0;     // 整批耗时 (墙钟时间)
+        size_t failed = 0;
+        
+        // 聚合吞吐量 (输入字节/秒)
+        double throughput() const { return seconds > 0 ? totalInput / seconds : 0; }
+    };
+    
+    // 批量处理选项
+    struct BatchOptions {
+        // 工作线程数 (0表示硬件线程数); 每个文件在单个线程内压缩, 大文件优先调度
+        unsigned threads = 0;
+        
+        // 单个文件的选项 (其中threads被忽略, 固定为1)
+        FileOptions file;
+    };
+    
+    // 批量压缩 (输入路径, 输出路径) 列表; 单个文件失败不会中断整批, 错误记录在结果中
+    static BatchResult compressFiles(const std::vector<std::pair<std::string, std::string>>& files,
+                                     int level = 6);
+    static BatchResult compressFiles(const std::vector<std::pair<std::string, std::string>>& files,
+                                     int level, const BatchOptions& options);
+    
+    // 递归压缩目录下的所有普通文件, 输出为同目录下的"原文件名+suffix" (已带suffix的文件跳过)
+    static BatchResult compressDirectory(const std::string& directory, const std::string& suffix = ".z",
+                                         int level = 6);
+    static BatchResult compressDirectory(const std::string& directory, const std::string& suffix,
+                                         int level, const BatchOptions& options);
     
     // === 流式操作 ===
     
+    // 刷新模式 (对应deflate的flush参数), 刷新后对端即可解压此前输入的全部数据
+    enum class FlushMode {
+        Sync,       // Z_SYNC_FLUSH: 输出按字节对齐
+        Full,       // Z_FULL_FLUSH: 同Sync并重置字典, 对端可从刷新点开始解压, 压缩率损失更大
+        Partial     // Z_PARTIAL_FLUSH: 输出不按字节对齐, 每次刷新的开销最小
+    };
+    
+    // 自动刷新策略: 自第一个未刷新的字节起, 累计输入达到everyBytes或经过everyMilliseconds时以mode刷新
+    // (0表示不启用该条件), 以少量压缩率换取有上限的端到端延迟
+    struct FlushPolicy {
+        FlushMode mode = FlushMode::Sync;
+        size_t everyBytes = 0;
+        unsigned everyMilliseconds = 0;
+        
+        bool enabled() const { return everyBytes > 0 || everyMilliseconds > 0; }
+    };
+    
+    // 流式操作选项
+    struct StreamOptions {
+        // 流水线模式 (仅压缩): 读取线程、压缩、写入线程三段并行, 通过循环使用的缓冲区交接.
+        // 出错时不等待阻塞在输入上的读取线程即抛出, 该线程完成当前这次读取后退出, 在此之前输入流须保持有效
+        bool pipelined = false;
+        
+        // 输入/输出缓冲区大小; 输出攒满整个缓冲区才写入输出流. 流水线模式下为每个槽位的大小
+        size_t inputBufferSize = 64 * 1024;
+        size_t outputBufferSize = 128 * 1024;
+        
+        // 调用方提供的缓冲区 (容量不小于对应的BufferSize), 为空时复用线程本地回收的缓冲区;
+        // 流水线模式不使用
+        uint8_t* inputBuffer = nullptr;
+        uint8_t* outputBuffer = nullptr;
+        
+        // 自适应模式: 从64KB起读取, 吞吐量仍在提升时把块大小逐步加倍, 上限为inputBufferSize
+        bool adaptive = false;
+        
+        // 自动刷新 (仅压缩): 启用时读取线程只取已到达的数据, 不等待填满缓冲区; 每次刷新后写出并flush输出流,
+        // 输入空闲时到期也会刷新. 启用时忽略pipelined/adaptive与调用方缓冲区.
+        // 输入流缓冲区需能报告已到达的字节数 (std::cin请先关闭sync_with_stdio), 否则逐字节读取.
+        // 输出出错时同pipelined立即抛出, 输入流须保持有效直到读取线程的当前这次读取返回
+        FlushPolicy autoFlush;
+        
+        // 解压改用inflateBack (同FileOptions::inflateBack), 仅用于Zip::decompressStream; 不使用输出缓冲区
+        bool inflateBack = false;
+        
+        // 压缩线程数 (0表示硬件线程数), 仅用于Zip::compressStream: 多线程时从输入流按blockSize读入定长块,
+        // 以前一块末尾32KB为字典并行压缩, 按顺序写出单个标准zlib流, 内存占用约为 4 * threads * blockSize.
+        // 优先于pipelined, 启用autoFlush时不使用
+        unsigned threads = 1;
+        size_t blockSize = 128 * 1024;
+    };
+    
     // 流式压缩 (处理大文件)
     static void compressStream(std::istream& input, std::ostream& output, int level = 6);
+    static void compressStream(std::istream& input, std::ostream& output, int level,
+                               const StreamOptions& options);
     
-    // 流式解压 (处理大文件)
+    // 流式解压 (处理大文件); 串接的成员依次解压
     static void decompressStream(std::istream& input, std::ostream& output);
+    static void decompressStream(std::istream& input, std::ostream& output, const StreamOptions& options);
+    
+#if defined(__unix__) || defined(__APPLE__)
+    // === 文件描述符I/O (绕过iostream, 适用于文件、管道、套接字与memfd) ===
+    
+    // 从inFd读取直到EOF, 压缩后写入outFd; 不关闭描述符.
+    // outFd以O_DIRECT打开时按对齐的整块写出, 尾部临时取消O_DIRECT写出
+    static void compressFd(int inFd, int outFd, int level = 6);
+    
+    // 从inFd读取zlib流, 解压后写入outFd; 不关闭描述符
+    static void decompressFd(int inFd, int outFd);
+#endif
     
     // === 实用工具 ===
     
@@ -48,6 +269,418 @@ public:
     
     // 获取压缩率
     static double compressionRatio(size_t originalSize, size_t compressedSize);
+    
+    // === 内存分配器 (用于zlib内部状态的zalloc/zfree) ===
+    
+    class Allocator {
+    public:
+        // 分配器统计 (字节数均为zlib请求的大小)
+        struct Stats {
+            size_t allocations = 0;      // 累计分配次数
+            size_t bytesAllocated = 0;   // 累计分配字节数
+            size_t bytesInUse = 0;       // 当前未释放的字节数
+            size_t peakBytesInUse = 0;   // bytesInUse的峰值
+            size_t bytesReserved = 0;    // 向系统申请的内存总量
+        };
+        
+        virtual ~Allocator() = default;
+        
+        // 分配失败时返回nullptr
+        virtual void* allocate(size_t size) = 0;
+        virtual void deallocate(void* ptr) = 0;
+        virtual Stats stats() const { return Stats(); }
+    };
+    
+    // 线程安全的池分配器: 按2的幂划分规格, 每种规格从slabSize大小的slab中切出固定槽位, 释放后复用
+    class PoolAllocator : public Allocator {
+    public:
+        explicit PoolAllocator(size_t slabSize = 1024 * 1024);
+        ~PoolAllocator() override;
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+        
+        void* allocate(size_t size) override;
+        void deallocate(void* ptr) override;
+        Stats stats() const override;
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 单个任务使用的区域分配器: 顺序分配, deallocate不回收, reset()后整体复用 (非线程安全)
+    class ArenaAllocator : public Allocator {
+    public:
+        explicit ArenaAllocator(size_t blockSize = 1024 * 1024);
+        ~ArenaAllocator() override;
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+        
+        void* allocate(size_t size) override;
+        void deallocate(void* ptr) override;
+        Stats stats() const override;
+        
+        // 回收全部内存以供下一个任务使用 (调用前必须销毁使用它的上下文)
+        void reset();
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 设置全局默认分配器 (nullptr表示malloc/free), 之后新建的上下文与静态接口都会使用它
+    // 分配器必须是线程安全的, 且生命周期长于所有使用它的上下文 (各线程可用trimContextCache释放缓存)
+    static void setDefaultAllocator(Allocator* allocator);
+    static Allocator* defaultAllocator();
+    
+    // === 线程本地上下文缓存 (静态接口自动复用按级别/窗口参数索引的上下文) ===
+    
+    // 设置每个线程每种上下文的缓存上限 (0表示不缓存), 同时裁剪当前线程的缓存
+    static void setContextCacheLimit(size_t maxContexts);
+    static size_t contextCacheLimit();
+    
+    // 释放当前线程缓存的上下文, 只保留最近使用的keep个
+    static void trimContextCache(size_t keep = 0);
+    
+    // === 可复用上下文 (持有z_stream, 两次调用之间只做reset, 不重新分配内部状态) ===
+    
+    // 压缩上下文 (windowBits/memLevel/strategy含义同deflateInit2, 默认15/8/Z_DEFAULT_STRATEGY)
+    // allocator为nullptr时使用全局默认分配器
+    class Compressor {
+    public:
+        explicit Compressor(int level = 6, int windowBits = 15, int memLevel = 8, int strategy = 0,
+                            Allocator* allocator = nullptr);
+        ~Compressor();
+        Compressor(Compressor&&) noexcept;
+        Compressor& operator=(Compressor&&) noexcept;
+        Compressor(const Compressor&) = delete;
+        Compressor& operator=(const Compressor&) = delete;
+        
+        std::vector<uint8_t> compress(const std::vector<uint8_t>& data);
+        // 写入调用方缓冲区; Zip::compressBound只对zlib格式 (windowBits为8..15) 足够
+        size_t compress(const uint8_t* data, size_t size, uint8_t* output, size_t outputCapacity);
+#ifdef __cpp_lib_span
+        size_t compress(std::span<const uint8_t> data, std::span<uint8_t> output) {
+            return compress(data.data(), data.size(), output.data(), output.size());
+        }
+#endif
+        // 压缩内存数据并写入输出流
+        void compress(const uint8_t* data, size_t size, std::ostream& output);
+        void compressStream(std::istream& input, std::ostream& output);
+        void compressStream(std::istream& input, std::ostream& output, const StreamOptions& options);
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 解压上下文 (windowBits含义同inflateInit2, 默认15即zlib格式)
+    class Decompressor {
+    public:
+        explicit Decompressor(int windowBits = 15, Allocator* allocator = nullptr);
+        ~Decompressor();
+        Decompressor(Decompressor&&) noexcept;
+        Decompressor& operator=(Decompressor&&) noexcept;
+        Decompressor(const Decompressor&) = delete;
+        Decompressor& operator=(const Decompressor&) = delete;
+        
+        std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressed);
+        std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressed,
+                                        size_t expectedSize, size_t maxOutputSize = SIZE_MAX);
+        size_t decompress(const uint8_t* compressed, size_t size, uint8_t* output, size_t outputCapacity);
+#ifdef __cpp_lib_span
+        size_t decompress(std::span<const uint8_t> compressed, std::span<uint8_t> output) {
+            return decompress(compressed.data(), compressed.size(), output.data(), output.size());
+        }
+#endif
+        // 解压内存数据并写入输出流
+        void decompress(const uint8_t* compressed, size_t size, std::ostream& output);
+        void decompressStream(std::istream& input, std::ostream& output);
+        void decompressStream(std::istream& input, std::ostream& output, const StreamOptions& options);
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // === 流缓冲区适配器 (在任意iostream上透明地增量压缩/解压) ===
+    
+    // 压缩流缓冲区: 写入的数据增量压缩后写入output, 输出攒满缓冲区才写入;
+    // sync() (即ostream::flush) 按刷新策略的模式 (默认Sync) 输出已写入的全部数据, finish()或析构时结束zlib流
+    class DeflateStreamBuf : public std::streambuf {
+    public:
+        explicit DeflateStreamBuf(std::ostream& output, int level = 6, size_t bufferSize = 256 * 1024);
+        ~DeflateStreamBuf() override;
+        
+        DeflateStreamBuf(const DeflateStreamBuf&) = delete;
+        DeflateStreamBuf& operator=(const DeflateStreamBuf&) = delete;
+        
+        // 结束zlib流并写出剩余数据, 之后不能再写入; 失败时抛出 (析构时的错误会被忽略)
+        void finish();
+        
+        // 设置sync()的刷新模式与自动刷新条件; 条件只在写入时检查, 没有写入时不会因超时而刷新
+        void setFlushPolicy(const FlushPolicy& policy);
+        
+    protected:
+        int_type overflow(int_type ch) override;
+        std::streamsize xsputn(const char_type* data, std::streamsize count) override;
+        int sync() override;
+        
+    private:
+        void flushIfDue();
+        
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 解压流缓冲区: 从input读取zlib流并增量解压, 到达流末尾后返回EOF;
+    // 大块读取直接解压到调用方内存. 输入损坏或提前结束时抛出 (istream中表现为badbit)
+    class InflateStreamBuf : public std::streambuf {
+    public:
+        explicit InflateStreamBuf(std::istream& input, size_t bufferSize = 256 * 1024);
+        ~InflateStreamBuf() override;
+        
+        InflateStreamBuf(const InflateStreamBuf&) = delete;
+        InflateStreamBuf& operator=(const InflateStreamBuf&) = delete;
+        
+    protected:
+        int_type underflow() override;
+        std::streamsize xsgetn(char_type* data, std::streamsize count) override;
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 压缩输出流, 析构时自动结束zlib流 (需要得知写入错误时先调用finish())
+    class DeflateOStream : public std::ostream {
+    public:
+        explicit DeflateOStream(std::ostream& output, int level = 6, size_t bufferSize = 256 * 1024);
+        
+        void finish();
+        void setFlushPolicy(const FlushPolicy& policy) { buffer_.setFlushPolicy(policy); }
+        
+    private:
+        DeflateStreamBuf buffer_;
+    };
+    
+    // 解压输入流
+    class InflateIStream : public std::istream {
+    public:
+        explicit InflateIStream(std::istream& input, size_t bufferSize = 256 * 1024);
+        
+    private:
+        InflateStreamBuf buffer_;
+    };
+    
+    // === 推送式增量接口 (非阻塞, 输出空间由调用方管理, 适用于事件驱动的服务端) ===
+    
+    // 一次推进的结果
+    struct Progress {
+        size_t consumed = 0;    // 消耗的输入字节数
+        size_t produced = 0;    // 写入输出的字节数
+        bool done = false;      // feed: 输入已全部消耗 (解压时为zlib流已结束); flush/finish: 输出已全部交出
+    };
+    
+    // 推送式压缩流: 数据分片到达时逐片feed; 输出空间不足时只推进一部分, 调用方腾出空间后
+    // 以剩余输入 (或再次flush/finish) 继续. finish()完成后需reset()才能开始新的流
+    class DeflateStream {
+    public:
+        explicit DeflateStream(int level = 6, int windowBits = 15, int memLevel = 8, int strategy = 0,
+                               Allocator* allocator = nullptr);
+        ~DeflateStream();
+        DeflateStream(DeflateStream&&) noexcept;
+        DeflateStream& operator=(DeflateStream&&) noexcept;
+        DeflateStream(const DeflateStream&) = delete;
+        DeflateStream& operator=(const DeflateStream&) = delete;
+        
+        // 设置了刷新策略时, 输入消耗完且条件满足后在同一次调用中刷新 (输出不足时done为false,
+        // 以空输入再次feed即可完成刷新)
+        Progress feed(const uint8_t* input, size_t size, uint8_t* output, size_t capacity);
+        // 交出已输入数据的全部压缩结果, 对端可立即解压
+        Progress flush(uint8_t* output, size_t capacity, FlushMode mode = FlushMode::Sync);
+        // 结束zlib流
+        Progress finish(uint8_t* output, size_t capacity);
+        
+        // 输出追加到output末尾 (按需扩展), 一次调用即完成
+        Progress feed(const uint8_t* input, size_t size, std::vector<uint8_t>& output);
+        Progress flush(std::vector<uint8_t>& output, FlushMode mode = FlushMode::Sync);
+        Progress finish(std::vector<uint8_t>& output);
+#ifdef __cpp_lib_span
+        Progress feed(std::span<const uint8_t> input, std::span<uint8_t> output) {
+            return feed(input.data(), input.size(), output.data(), output.size());
+        }
+        Progress feed(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+            return feed(input.data(), input.size(), output);
+        }
+        Progress flush(std::span<uint8_t> output, FlushMode mode = FlushMode::Sync) {
+            return flush(output.data(), output.size(), mode);
+        }
+        Progress finish(std::span<uint8_t> output) { return finish(output.data(), output.size()); }
+#endif
+        
+        // 自动刷新策略 (默认不启用); 事件循环可在定时器中检查flushDue(), 为true时调用flush
+        void setFlushPolicy(const FlushPolicy& policy);
+        bool flushDue() const;
+        
+        // 丢弃当前状态, 开始新的流
+        void reset();
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // 推送式解压流: done为true表示zlib流已结束, consumed之后的输入不属于该流
+    class InflateStream {
+    public:
+        explicit InflateStream(int windowBits = 15, Allocator* allocator = nullptr);
+        ~InflateStream();
+        InflateStream(InflateStream&&) noexcept;
+        InflateStream& operator=(InflateStream&&) noexcept;
+        InflateStream(const InflateStream&) = delete;
+        InflateStream& operator=(const InflateStream&) = delete;
+        
+        Progress feed(const uint8_t* input, size_t size, uint8_t* output, size_t capacity);
+        Progress feed(const uint8_t* input, size_t size, std::vector<uint8_t>& output);
+#ifdef __cpp_lib_span
+        Progress feed(std::span<const uint8_t> input, std::span<uint8_t> output) {
+            return feed(input.data(), input.size(), output.data(), output.size());
+        }
+        Progress feed(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+            return feed(input.data(), input.size(), output);
+        }
+#endif
+        
+        // zlib流是否已结束
+        bool finished() const;
+        
+        // 丢弃当前状态, 开始新的流
+        void reset();
+        
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+    
+    // === 异步接口 (在专用的压缩线程池中执行, 调用线程不阻塞) ===
+    
+    // 完成回调, 在池线程中调用; error为空表示成功. 回调抛出的异常被忽略
+    using AsyncCallback = std::function<void(std::exception_ptr error)>;
+    using AsyncResultCallback = std::function<void(std::vector<uint8_t> result, std::exception_ptr error)>;
+    
+    // 设置压缩线程池的线程数 (0表示硬件线程数, 默认), 已有的线程池执行完排队的任务后替换;
+    // 不能在异步任务或回调中调用. 文件操作本身的多线程由FileOptions::threads控制: 不带options的
+    // 异步文件接口按单线程执行, 传入options时threads为0会使每个任务再启动硬件线程数的线程
+    static void setAsyncThreads(unsigned threads);
+    
+    // 在压缩线程池中执行work, 完成后以其抛出的异常 (或空) 调用done
+    static void runAsync(std::function<void()> work, AsyncCallback done);
+    
+    static void compressFileAsync(const std::string& inputPath, const std::string& outputPath, int level,
+                                  const FileOptions& options, AsyncCallback done);
+    static void decompressFileAsync(const std::string& inputPath, const std::string& outputPath,
+                                    const FileOptions& options, AsyncCallback done);
+    // 流在完成回调之前必须保持有效, 且不能被其他线程使用
+    static void compressStreamAsync(std::istream& input, std::ostream& output, int level,
+                                    const StreamOptions& options, AsyncCallback done);
+    static void decompressStreamAsync(std::istream& input, std::ostream& output, AsyncCallback done);
+    static void compressAsync(std::vector<uint8_t> data, int level, AsyncResultCallback done);
+    static void decompressAsync(std::vector<uint8_t> compressed, AsyncResultCallback done);
+    
+#ifdef ZIP_HAVE_COROUTINES
+    // C++20可等待对象: co_await时挂起当前协程, 在压缩线程池中执行操作 (含文件与流的I/O),
+    // 完成后恢复协程并返回结果或重新抛出异常. 默认在池线程中恢复, resumeOn(post)改为由post把协程
+    // 投递回调用方的执行器. 对象须在co_await表达式中使用 (不等待则什么也不做), 不能复制后多次等待
+    template <typename T>
+    class [[nodiscard]] Async {
+    public:
+        using Resumer = std::function<void(std::coroutine_handle<>)>;
+        
+        explicit Async(std::function<T()> work) : work_(std::move(work)) {}
+        
+        Async resumeOn(Resumer resumer) && {
+            resumer_ = std::move(resumer);
+            return std::move(*this);
+        }
+        
+        bool await_ready() const noexcept { return false; }
+        
+        void await_suspend(std::coroutine_handle<> handle) {
+            // 恢复后协程可能立即销毁本对象, 之后不再访问成员
+            runAsync([this] { run(); }, [this, handle](std::exception_ptr error) {
+                error_ = error;
+                Resumer resumer = std::move(resumer_);
+                if (resumer) {
+                    resumer(handle);
+                } else {
+                    handle.resume();
+                }
+            });
+        }
+        
+        T await_resume() {
+            if (error_) std::rethrow_exception(error_);
+            if constexpr (!std::is_void_v<T>) return std::move(*result_);
+        }
+        
+    private:
+        void run() {
+            if constexpr (std::is_void_v<T>) {
+                work_();
+            } else {
+                result_.emplace(work_());
+            }
+        }
+        
+        std::function<T()> work_;
+        Resumer resumer_;
+        std::optional<std::conditional_t<std::is_void_v<T>, char, T>> result_;
+        std::exception_ptr error_;
+    };
+    
+    // co_await Zip::compressFileAsync(src, dst, 6, options)
+    static Async<void> compressFileAsync(const std::string& inputPath, const std::string& outputPath,
+                                         int level = 6) {
+        FileOptions options;
+        options.threads = 1;
+        return compressFileAsync(inputPath, outputPath, level, options);
+    }
+    static Async<void> compressFileAsync(const std::string& inputPath, const std::string& outputPath,
+                                         int level, const FileOptions& options) {
+        return Async<void>([=] { compressFile(inputPath, outputPath, level, options); });
+    }
+    
+    static Async<void> decompressFileAsync(const std::string& inputPath, const std::string& outputPath) {
+        FileOptions options;
+        options.threads = 1;
+        return decompressFileAsync(inputPath, outputPath, options);
+    }
+    static Async<void> decompressFileAsync(const std::string& inputPath, const std::string& outputPath,
+                                           const FileOptions& options) {
+        return Async<void>([=] { decompressFile(inputPath, outputPath, options); });
+    }
+    
+    static Async<void> compressStreamAsync(std::istream& input, std::ostream& output, int level = 6) {
+        return compressStreamAsync(input, output, level, StreamOptions());
+    }
+    static Async<void> compressStreamAsync(std::istream& input, std::ostream& output, int level,
+                                           const StreamOptions& options) {
+        return Async<void>([&input, &output, level, options] { compressStream(input, output, level, options); });
+    }
+    
+    static Async<void> decompressStreamAsync(std::istream& input, std::ostream& output) {
+        return Async<void>([&input, &output] { decompressStream(input, output); });
+    }
+    
+    static Async<std::vector<uint8_t>> compressAsync(std::vector<uint8_t> data, int level = 6) {
+        return Async<std::vector<uint8_t>>([data = std::move(data), level] { return compress(data, level); });
+    }
+    
+    static Async<std::vector<uint8_t>> decompressAsync(std::vector<uint8_t> compressed) {
+        return Async<std::vector<uint8_t>>([compressed = std::move(compressed)] { return decompress(compressed); });
+    }
+#endif
 };
 
 #endif // ZIP_H
\ No newline at end of file